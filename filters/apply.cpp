@@ -1,6 +1,6 @@
 /**
  * @file apply.cpp
- * @brief This source file contains code for applying filter to the signal.
+ * @brief This source file contains code for splitting the signal between the threads.
  * @author Krzysztof Adamkiewicz
  * @date 1/10/2019
  */
@@ -21,47 +21,86 @@
 // OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  
 
 #include "filters.hpp"
-#include <thread>
 #include <algorithm>
 
 /**
- * @brief Aply filter to the signal
- * @param signal Input signal. Signal is not modified by the applyFilter function. 
- * @param threadCount Number of threads on which the filter will run.
- * @param filter Filter function.
- * @param params Filter parameters.
- * @return Vector containing filtered signal.
+ * @brief Split the range into chunks of (almost) equal size. Every chunk gets
+ * a read-only halo of neighbouring samples, clipped to the readable part of the range.
+ * @param range Samples to split, < begin, end ), and readable samples, < first, last ).
+ * @param chunkCount Requested number of chunks. Fewer chunks are returned for very short ranges.
+ * @param halo Halo required by the filter.
+ * @return List of chunks covering the whole range.
  */
-std::vector<double> applyFilter(std::vector<double>& signal, unsigned int threadCount, Filter filter, const std::vector<FilterParameter>& params)
+std::vector<SignalChunk> partitionSignal(const SignalChunk& range, size_t chunkCount, const Halo& halo)
 {
-    //validate thread count
-    if(threadCount < 1)
-        threadCount = 1;
-    
-    //choose block size
-    const size_t batchSize = signal.size()/threadCount;
-    
-    //allocate memory for tbe output
-    std::vector<double> output(signal.size());
+    const size_t length = range.end - range.begin;
+    chunkCount = std::max<size_t>(std::min(chunkCount, length), 1);
 
-    //build worker pool
-    std::vector<std::thread> workers(threadCount);//worker pool
-    
-    //worker
-    auto worker = [&params, &filter](auto target_it, auto begin_it, auto end_it){ filter(target_it, begin_it, end_it, params); };
-    
-    //start workers
-    auto it = std::begin(signal);
-    auto targetIt = std::begin(output);
-    for(unsigned int i=0; i<threadCount; i++)
+    //first length%chunkCount chunks get one extra sample
+    const size_t chunkSize = length/chunkCount;
+    const size_t remainder = length%chunkCount;
+
+    std::vector<SignalChunk> chunks(chunkCount);
+    size_t position = range.begin;
+    for(size_t i=0; i<chunkCount; i++)
     {
-        workers[i] = std::thread(worker, targetIt, it, std::next(it, batchSize));
-        std::advance(it, batchSize);
-        std::advance(targetIt, batchSize);
+        SignalChunk& chunk = chunks[i];
+        chunk.begin = position;
+        chunk.end = position + chunkSize + (i < remainder ? 1 : 0);
+        chunk.first = chunk.begin - std::min(chunk.begin - range.first, halo.before);
+        chunk.last = chunk.end + std::min(range.last - chunk.end, halo.after);
+        position = chunk.end;
     }
-    
-    //wait for workers to finish
-    std::for_each(std::begin(workers), std::end(workers), [](std::thread& thread){ thread.join(); });
-    
-    return output;
+
+    return chunks;
+}
+
+/**
+ * @brief Split the range into tiles of at most tileSize samples.
+ * @param range Samples to split and readable samples.
+ * @param tileSize Maximal number of samples in a tile. 0 selects DEFAULT_TILE_SIZE.
+ * @param minTileCount Minimal number of tiles, so that short signals still keep every thread busy.
+ * @param halo Halo required by the filter.
+ * @return List of tiles covering the whole range.
+ */
+std::vector<SignalChunk> tileSignal(const SignalChunk& range, size_t tileSize, size_t minTileCount, const Halo& halo)
+{
+    if(tileSize == 0)
+        tileSize = DEFAULT_TILE_SIZE;
+
+    const size_t tileCount = (range.end - range.begin + tileSize - 1)/tileSize;
+    return partitionSignal(range, std::max(tileCount, minTileCount), halo);
+}
+
+/**
+ * @brief Cut the range into tiles and run task for every tile on the pool.
+ * Tiles are balanced between the threads by work stealing.
+ * @param pool Thread pool on which the tasks will run.
+ * @param range Samples to split and readable samples.
+ * @param tileSize Number of samples in a single tile.
+ * @param halo Halo required by the filter.
+ * @param task Task receiving the tile.
+ */
+void forEachTile(ThreadPool& pool, const SignalChunk& range, size_t tileSize, const Halo& halo, const std::function<void(const SignalChunk&)>& task)
+{
+    const std::vector<SignalChunk> chunks = tileSignal(range, tileSize, pool.size(), halo);
+    pool.run(chunks.size(), [&](size_t i){ task(chunks[i]); });
+}
+
+/**
+ * @brief Cut the range of every channel into tiles and run task for every (channel, tile) pair on the pool.
+ * Channels are only split along time as much as needed to give every thread work, so signals
+ * with many short channels are parallelised across channels.
+ * @param pool Thread pool on which the tasks will run.
+ * @param channels Number of channels.
+ * @param range Samples to split and readable samples, the same for every channel.
+ * @param tileSize Number of samples in a single tile.
+ * @param halo Halo required by the filter.
+ * @param task Task receiving the channel and the tile.
+ */
+void forEachChannelTile(ThreadPool& pool, size_t channels, const SignalChunk& range, size_t tileSize, const Halo& halo, const std::function<void(size_t, const SignalChunk&)>& task)
+{
+    const size_t minTileCount = (pool.size() + channels - 1)/channels;
+    const std::vector<SignalChunk> tiles = tileSignal(range, tileSize, minTileCount, halo);
+    pool.run(channels*tiles.size(), [&](size_t i){ task(i/tiles.size(), tiles[i%tiles.size()]); });
 }
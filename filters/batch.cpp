@@ -0,0 +1,370 @@
+/**
+ * @file batch.cpp
+ * @brief This source file contains the batch mode, which filters many files with overlapped I/O.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#include "batch.hpp"
+#include <fstream>
+#include <sstream>
+#include <future>
+#include <variant>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <glob.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** @brief Samples in the type they are stored in. */
+typedef std::variant<std::vector<double>, std::vector<float>, std::vector<int16_t>, std::vector<int32_t>> StoredSamples;
+
+/** @brief Filtered samples. */
+typedef std::variant<std::vector<double>, std::vector<float>> FilteredSamples;
+
+/**
+ * @brief Input file loaded into memory.
+ */
+struct LoadedSignal final
+{
+    NpyHeader header; /** @brief Header of the file. */
+    StoredSamples samples; /** @brief Samples. */
+    long double loadTime; /** @brief Time spent loading the file [s]. */
+};
+
+/**
+ * @brief Single long lived thread running submitted tasks one after another.
+ * Pending tasks are finished before the thread is joined.
+ */
+class TaskThread final
+{
+public:
+    TaskThread() : thread(&TaskThread::loop, this) {}
+    TaskThread(const TaskThread&) = delete;
+    TaskThread& operator=(const TaskThread&) = delete;
+    
+    ~TaskThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_one();
+        thread.join();
+    }
+    
+    /**
+     * @brief Queue the task.
+     * @param function Task.
+     * @return Future holding the result or the exception of the task.
+     */
+    template<typename Function>
+    auto submit(Function function) -> std::future<decltype(function())>
+    {
+        const auto task = std::make_shared<std::packaged_task<decltype(function())()>>(std::move(function));
+        std::future<decltype(function())> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back([task](){ (*task)(); });
+        }
+        wakeUp.notify_one();
+        return result;
+    }
+
+private:
+    void loop()
+    {
+        while(true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [this](){ return stopping || !tasks.empty(); });
+                if(tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+    
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::deque<std::function<void()>> tasks;
+    bool stopping = false;
+    std::thread thread; //last, so it starts after the rest is constructed
+};
+
+/**
+ * @brief Read list of jobs from the manifest. Every line holds input and output file name
+ * separated by whitespace. Empty lines and lines starting with # are skipped.
+ * @param fileName Name of the manifest.
+ * @return List of jobs.
+ * @throw std::runtime_error If the manifest can't be read or has a line without output file.
+ */
+std::vector<BatchJob> readManifest(const std::string& fileName)
+{
+    std::ifstream manifest(fileName);
+    if(!manifest)
+        throw std::runtime_error("Can't open " + fileName + "!");
+    
+    std::vector<BatchJob> jobs;
+    std::string line;
+    for(size_t lineNumber=1; std::getline(manifest, line); lineNumber++)
+    {
+        std::istringstream fields(line);
+        BatchJob job;
+        if(!(fields >> job.inputFile) || job.inputFile[0] == '#')
+            continue;
+        if(!(fields >> job.outputFile))
+            throw std::runtime_error(fileName + ":" + std::to_string(lineNumber) + ": missing output file!");
+        jobs.push_back(job);
+    }
+    
+    return jobs;
+}
+
+/**
+ * @brief Check that files can be created in the directory.
+ * @param directory Directory name.
+ * @throw std::runtime_error If the directory does not exist or is not writable.
+ */
+static void checkOutputDirectory(const std::string& directory)
+{
+    struct stat status;
+    if(stat(directory.c_str(), &status) != 0 || !S_ISDIR(status.st_mode))
+        throw std::runtime_error("Output directory " + directory + " does not exist!");
+    if(access(directory.c_str(), W_OK | X_OK) != 0)
+        throw std::runtime_error("Output directory " + directory + " is not writable!");
+}
+
+/**
+ * @brief Get directory of the file.
+ * @param fileName File name.
+ * @return Directory name, . for bare file names.
+ */
+static std::string directoryOf(const std::string& fileName)
+{
+    const size_t slash = fileName.find_last_of('/');
+    if(slash == std::string::npos)
+        return ".";
+    
+    return slash == 0 ? "/" : fileName.substr(0, slash);
+}
+
+/**
+ * @brief Make jobs for all files matching the pattern. Output files get the name of the
+ * input file and are placed in the output directory.
+ * @param pattern Shell wildcard pattern.
+ * @param outputDirectory Directory for the output files.
+ * @return List of jobs, sorted by input file name.
+ * @throw std::runtime_error If no file matches the pattern or the output directory can't be written.
+ */
+std::vector<BatchJob> globJobs(const std::string& pattern, const std::string& outputDirectory)
+{
+    checkOutputDirectory(outputDirectory);
+    
+    glob_t matches;
+    const int result = glob(pattern.c_str(), 0, nullptr, &matches);
+    if(result != 0)
+    {
+        globfree(&matches);
+        throw std::runtime_error("No files match " + pattern + "!");
+    }
+    
+    std::vector<BatchJob> jobs;
+    for(size_t i=0; i<matches.gl_pathc; i++)
+    {
+        const std::string inputFile = matches.gl_pathv[i];
+        const size_t slash = inputFile.find_last_of('/');
+        const std::string name = slash == std::string::npos ? inputFile : inputFile.substr(slash+1);
+        jobs.push_back({inputFile, outputDirectory + "/" + name});
+    }
+    globfree(&matches);
+    
+    return jobs;
+}
+
+/**
+ * @brief Load the file in the type it is stored in.
+ * @param fileName Name of the file.
+ * @return Loaded signal.
+ * @throw std::runtime_error If the file can't be read or does not hold a supported signal.
+ */
+static LoadedSignal loadStoredSignal(const std::string& fileName)
+{
+    StopWatch watch;
+    watch.start();
+    
+    LoadedSignal signal;
+    signal.header = readNpyHeader(fileName);
+    validateSignalHeader(signal.header);
+    if(signal.header.type == 'i')
+    {
+        if(signal.header.wordSize == sizeof(int16_t))
+            signal.samples = loadSignal<int16_t>(fileName);
+        else
+            signal.samples = loadSignal<int32_t>(fileName);
+    }
+    else if(signal.header.wordSize == sizeof(float))
+        signal.samples = loadSignal<float>(fileName);
+    else
+        signal.samples = loadSignal<double>(fileName);
+    
+    watch.stop();
+    signal.loadTime = watch.getTime();
+    return signal;
+}
+
+/**
+ * @brief Filter every file of the batch on the shared pool.
+ * Loading of the next file and saving of the previous one run on a loader and a saver thread,
+ * both kept for the whole batch, while the current file is filtered, so at most three files
+ * are held in memory.
+ * A file that fails is recorded and skipped, the rest of the batch continues. Output directories
+ * are checked before anything is loaded, so jobs that could not be saved are not filtered.
+ * @param jobs List of jobs.
+ * @param filter Filter to run.
+ * @param pool Thread pool on which the filter will run.
+ * @param tileSize Number of samples filtered by a single task.
+ * @param scale Conversion of integer input samples.
+ * @return Batch statistics.
+ */
+BatchStatistics runBatch(const std::vector<BatchJob>& jobs, const FilterRunner& filter, ThreadPool& pool, size_t tileSize, const InputScale& scale)
+{
+    BatchStatistics stats;
+    if(jobs.empty())
+        return stats;
+    
+    StopWatch wallWatch;
+    wallWatch.start();
+    
+    //skip jobs whose output could not be saved, every directory is checked once
+    std::map<std::string, std::string> directoryErrors;
+    std::vector<size_t> runnable;
+    for(size_t i=0; i<jobs.size(); i++)
+    {
+        const std::string directory = directoryOf(jobs[i].outputFile);
+        auto checked = directoryErrors.find(directory);
+        if(checked == directoryErrors.end())
+        {
+            std::string error;
+            try
+            {
+                checkOutputDirectory(directory);
+            }
+            catch(std::exception& err)
+            {
+                error = err.what();
+            }
+            checked = directoryErrors.emplace(directory, error).first;
+        }
+        
+        if(checked->second.empty())
+            runnable.push_back(i);
+        else
+            stats.failures.push_back({jobs[i], checked->second});
+    }
+    if(runnable.empty())
+    {
+        wallWatch.stop();
+        stats.wallTime = wallWatch.getTime();
+        return stats;
+    }
+    
+    TaskThread loader;
+    TaskThread saver;
+    
+    //saving of the previous file
+    std::future<long double> saving;
+    size_t savingJob = 0;
+    const auto finishSave = [&]()
+    {
+        if(!saving.valid())
+            return;
+        try
+        {
+            stats.saveTime += saving.get();
+            stats.files++;
+        }
+        catch(std::exception& err)
+        {
+            stats.failures.push_back({jobs[savingJob], err.what()});
+        }
+    };
+    
+    const auto load = [&loader](const std::string& fileName){ return loader.submit([fileName](){ return loadStoredSignal(fileName); }); };
+    std::future<LoadedSignal> next = load(jobs[runnable[0]].inputFile);
+    for(size_t r=0; r<runnable.size(); r++)
+    {
+        const size_t i = runnable[r];
+        std::future<LoadedSignal> current = std::move(next);
+        if(r+1 < runnable.size())
+            next = load(jobs[runnable[r+1]].inputFile);
+        
+        try
+        {
+            LoadedSignal signal = current.get();
+            stats.loadTime += signal.loadTime;
+            const SignalLayout layout = signalLayout(signal.header);
+            
+            //filter in the sample type that matches the stored type
+            StopWatch filterWatch;
+            filterWatch.start();
+            FilteredSamples output = std::visit([&](const auto& stored) -> FilteredSamples
+            {
+                typedef typename std::decay_t<decltype(stored)>::value_type Raw;
+                std::vector<typename FilterSampleType<Raw>::type> filtered(layout.channels*filter.outputLength(layout.length));
+                filter.run(stored.data(), layout, filtered.data(), scale, pool, tileSize);
+                return filtered;
+            }, signal.samples);
+            filterWatch.stop();
+            stats.filterTime += filterWatch.getTime();
+            
+            stats.samples += layout.size();
+            stats.inputBytes += layout.size()*signal.header.wordSize;
+            stats.outputBytes += std::visit([](const auto& filtered){ return filtered.size()*sizeof(filtered[0]); }, output);
+            
+            //only one file waits for saving at any time
+            finishSave();
+            savingJob = i;
+            saving = saver.submit([samples = std::move(output), shape = filter.outputShape(signal.header.shape), fileName = jobs[i].outputFile]()
+            {
+                StopWatch saveWatch;
+                saveWatch.start();
+                std::visit([&](const auto& filtered){ saveSignal(filtered, shape, fileName); }, samples);
+                saveWatch.stop();
+                return saveWatch.getTime();
+            });
+        }
+        catch(std::exception& err)
+        {
+            stats.failures.push_back({jobs[i], err.what()});
+        }
+    }
+    finishSave();
+    
+    wallWatch.stop();
+    stats.wallTime = wallWatch.getTime();
+    return stats;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file batch.hpp
+ * @brief This header file contains declarations of the batch mode.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#ifndef BATCH_HPP_INCLUDED
+#define BATCH_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include "utils.hpp"
+#include "filters.hpp"
+
+/**
+ * @brief Single file of the batch.
+ */
+struct BatchJob final
+{
+    std::string inputFile; /** @brief Input file name. */
+    std::string outputFile; /** @brief Output file name. */
+};
+
+/**
+ * @brief File of the batch that could not be processed.
+ */
+struct BatchFailure final
+{
+    BatchJob job; /** @brief Failed job. */
+    std::string message; /** @brief Error message. */
+};
+
+/**
+ * @brief Statistics of the batch run.
+ */
+struct BatchStatistics final
+{
+    size_t files = 0; /** @brief Number of successfully filtered files. */
+    size_t samples = 0; /** @brief Number of filtered samples, all channels included. */
+    size_t inputBytes = 0; /** @brief Size of the loaded samples. */
+    size_t outputBytes = 0; /** @brief Size of the saved samples. */
+    long double wallTime = 0; /** @brief Duration of the whole batch [s]. */
+    long double loadTime = 0; /** @brief Time spent loading files, overlapped with filtering [s]. */
+    long double filterTime = 0; /** @brief Time spent filtering [s]. */
+    long double saveTime = 0; /** @brief Time spent saving files, overlapped with filtering [s]. */
+    std::vector<BatchFailure> failures; /** @brief Files that could not be processed. */
+};
+
+std::vector<BatchJob> readManifest(const std::string& fileName);
+std::vector<BatchJob> globJobs(const std::string& pattern, const std::string& outputDirectory);
+BatchStatistics runBatch(const std::vector<BatchJob>& jobs, const FilterRunner& filter, ThreadPool& pool, size_t tileSize, const InputScale& scale);
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file compensatedsum.hpp
+ * @brief This header file contains the compensated sum used by the averaging filters.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#ifndef COMPENSATEDSUM_HPP_INCLUDED
+#define COMPENSATEDSUM_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @brief Sum with Neumaier style error compensation. Rounding error of every
+ * addition is captured with TwoSum and accumulated separately.
+ */
+class CompensatedSum final
+{
+public:
+    void add(double value)
+    {
+        const double total = sum + value;
+        const double valuePart = total - sum;
+        compensation += (sum - (total - valuePart)) + (value - valuePart);
+        sum = total;
+    }
+    
+    double value() const
+    {
+        return sum + compensation;
+    }
+
+private:
+    double sum = 0;
+    double compensation = 0;
+};
+
+/**
+ * @brief Compensated sum of a window sliding over the signal. Sum is recomputed from the
+ * window samples once it has slid by 16 windows, but not more often than every 65536 samples,
+ * so rounding drift stays bounded however long the signal is.
+ */
+class SlidingSum final
+{
+public:
+    explicit SlidingSum(size_t blockSize):
+    resumInterval(std::max<size_t>(16*blockSize, 65536)),
+    sinceResum(resumInterval)
+    {
+    }
+    
+    /** @brief Check whether the sum should be recomputed before the next slide. */
+    bool stale() const
+    {
+        return sinceResum >= resumInterval;
+    }
+    
+    /** @brief Recompute the sum from the window samples, oldest first. */
+    template<typename Sample>
+    void resum(const Sample* begin, const Sample* end)
+    {
+        sum = CompensatedSum();
+        for(const Sample* x=begin; x<end; x++)
+            sum.add(*x);
+        sinceResum = 0;
+    }
+    
+    /** @brief Slide the window by one sample. */
+    void slide(double entering, double leaving)
+    {
+        sum.add(entering);
+        sum.add(-leaving);
+        sinceResum++;
+    }
+    
+    double value() const
+    {
+        return sum.value();
+    }
+
+private:
+    size_t resumInterval;
+    size_t sinceResum;
+    CompensatedSum sum;
+};
+
+#endif
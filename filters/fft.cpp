@@ -0,0 +1,119 @@
+/**
+ * @file fft.cpp
+ * @brief This source file contains the fast Fourier transform.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#include "fft.hpp"
+#include "filters.hpp"
+#include "simd.hpp"
+#include <cmath>
+#include <utility>
+
+/**
+ * @brief Prepare transform of the given size.
+ * @param size Number of points. Must be a power of two, at least 4.
+ * @throw InvalidParameter If size is not a power of two or is smaller than 4.
+ */
+Fft::Fft(size_t size):
+n(size)
+{
+    if(n < 4 || (n & (n-1)) != 0)
+        throw(InvalidParameter("FFT size must be a power of two, at least 4!"));
+    
+    //bit reversal permutation as a list of swaps
+    for(size_t i=1, j=0; i<n; i++)
+    {
+        size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        
+        if(i < j)
+            swaps.push_back({i, j});
+    }
+    
+    //twiddles of every stage one after another, e^(-pi*i*k/half) for k < half
+    //computed directly so there is no accumulated error
+    const double pi = std::acos(-1.0);
+    for(size_t half=1; half<n; half<<=1)
+    {
+        for(size_t k=0; k<half; k++)
+        {
+            twiddleReal.push_back(std::cos(pi*k/half));
+            twiddleImag.push_back(-std::sin(pi*k/half));
+        }
+    }
+}
+
+/**
+ * @brief Get number of points.
+ * @return Number of points.
+ */
+size_t Fft::size() const
+{
+    return n;
+}
+
+/**
+ * @brief Forward transform in place.
+ * @param real Real parts of size() points.
+ * @param imag Imaginary parts of size() points.
+ */
+void Fft::forward(double* real, double* imag) const
+{
+    for(const std::pair<size_t, size_t>& swap : swaps)
+    {
+        std::swap(real[swap.first], real[swap.second]);
+        std::swap(imag[swap.first], imag[swap.second]);
+    }
+    
+    simdKernels<double>().fftStages(real, imag, n, twiddleReal.data(), twiddleImag.data());
+}
+
+/**
+ * @brief Inverse transform in place, scaled by 1/size(), so it undoes forward().
+ * Swapping real and imaginary parts turns the forward transform into the inverse one.
+ * @param real Real parts of size() points.
+ * @param imag Imaginary parts of size() points.
+ */
+void Fft::inverse(double* real, double* imag) const
+{
+    forward(imag, real);
+    
+    const double scale = 1.0/n;
+    for(size_t i=0; i<n; i++)
+    {
+        real[i] *= scale;
+        imag[i] *= scale;
+    }
+}
+
+/**
+ * @brief Find the smallest transform size that holds the given number of points.
+ * @param size Number of points.
+ * @return Power of two not smaller than size.
+ */
+size_t fftSizeFor(size_t size)
+{
+    size_t n = 1;
+    while(n < size)
+        n <<= 1;
+    return n;
+}
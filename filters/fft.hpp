@@ -0,0 +1,53 @@
+/**
+ * @file fft.hpp
+ * @brief This header file contains declaration of the fast Fourier transform.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#ifndef FFT_HPP_INCLUDED
+#define FFT_HPP_INCLUDED
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @brief Radix-2 fast Fourier transform of a fixed power of two size.
+ * Twiddle factors and the bit reversal permutation are computed once, the transform
+ * itself works in place on buffers owned by the caller, so one instance can be shared by all threads.
+ * Real and imaginary parts are kept in separate arrays, so butterflies of a stage run in vector registers.
+ */
+class Fft final
+{
+public:
+    explicit Fft(size_t size);
+    size_t size() const;
+    void forward(double* real, double* imag) const;
+    void inverse(double* real, double* imag) const;
+
+private:
+    size_t n;
+    std::vector<std::pair<size_t, size_t>> swaps;
+    std::vector<double> twiddleReal;
+    std::vector<double> twiddleImag;
+};
+
+size_t fftSizeFor(size_t size);
+
+#endif
@@ -21,10 +21,20 @@
 // OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  
  
 #include "filters.hpp"
+#include "slidingmedian.hpp"
+#include "medianetwork.hpp"
+#include "compensatedsum.hpp"
+#include "polyfit.hpp"
+#include "simd.hpp"
 #include <algorithm>
 #include <numeric>
 #include <iterator>
 #include <functional>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <complex>
 
 class NotFound final : public std::exception{};
 
@@ -46,16 +56,32 @@ inline double findParameter(const std::string& paramName, const std::vector<Filt
 }
 
 /**
- * @brief Moving average filter. Will apply filter between < rangeStart, rangeEnd ),
- * @param target Start of the range where we suppose to put the results.
- * @param rangeStart Start the signal.
- * @param rangeEnd End of the signal.
+ * @brief Find the text parameter in the parameter list.
+ * @param paramName Parameter name.
+ * @param params Parameters array.
+ * @return Parameter text.
+ * @throw NotFound If parameter is not on the list.
+ */
+inline const std::string& findTextParameter(const std::string& paramName, const std::vector<FilterParameter>& params)
+{
+    auto found = std::find_if(params.begin(), params.end(), [paramName](const FilterParameter& x) -> bool { return x.name == paramName; });
+    
+    if(found == params.end())
+        throw(NotFound());
+    
+    return (*found).text;
+}
+
+/**
+ * @brief Read block size parameter.
  * @param params Parameters.
- * @throw MissingParameter If required parameters are not provided.
+ * @return Block size.
+ * @throw MissingParameter If block size is not provided.
+ * @throw InvalidParameter If block size is smaller than 1.
  */
-void movingAverage_filter(std::vector<double>::iterator target, std::vector<double>::iterator rangeStart, std::vector<double>::iterator rangeEnd, const std::vector<FilterParameter>& params)
+inline size_t getBlockSize(const std::vector<FilterParameter>& params)
 {
-    size_t blockSize;
+    double blockSize;
     try
     {
         blockSize = findParameter("block-size", params);
@@ -65,83 +91,1634 @@ void movingAverage_filter(std::vector<double>::iterator target, std::vector<doub
         throw(MissingParameter("Missing block-size parameter!"));
     }
     
-    //copy first blockSize-1 elements to target
-    std::copy(rangeStart, std::next(rangeStart, blockSize-1), target);
-    target=std::next(target, blockSize-1);
-    for(auto it=std::next(rangeStart, blockSize-1); it<rangeEnd; std::advance(it, 1))
+    if(blockSize < 1)
+        throw(InvalidParameter("Block size must be at least 1!"));
+    
+    return blockSize;
+}
+
+/**
+ * @brief Read damping coefficient parameter.
+ * @param params Parameters.
+ * @return Damping coefficient.
+ * @throw MissingParameter If damping coefficient is not provided.
+ * @throw InvalidParameter If damping coefficient is out of ( 0, 1 >.
+ */
+inline double getDampingCoeff(const std::vector<FilterParameter>& params)
+{
+    double alpha;
+    try
+    {
+        alpha = findParameter("damping-coeff", params);
+    }
+    catch(NotFound& err)
     {
-        *target = std::accumulate(std::prev(it, blockSize-1), it+1, 0.0)/blockSize;
-        std::advance(target, 1);
+        throw(MissingParameter("Missing damping-coeff parameter!"));
     }
+    
+    //recursion decays by 1-alpha per sample, outside of the range it diverges
+    if(!(alpha > 0 && alpha <= 1))
+        throw(InvalidParameter("Damping coefficient must be greater than 0 and at most 1!"));
+    
+    return alpha;
 }
 
 /**
- * @brief Moving average filter. Will apply filter between < rangeStart, rangeEnd),
- * @param target Start of the range where we suppose to put the results.
- * @param rangeStart Start the signal.
- * @param rangeEnd End of the signal.
+ * @brief Read standard deviation of the Gaussian filter.
  * @param params Parameters.
- * @throw MissingParameter If required parameters are not provided.
+ * @return Sigma [samples].
+ * @throw MissingParameter If sigma is not provided.
+ * @throw InvalidParameter If sigma is out of < 0.5, 10000 >.
  */
-void exponential_filter(std::vector<double>::iterator target, std::vector<double>::iterator rangeStart, std::vector<double>::iterator rangeEnd, const std::vector<FilterParameter>& params)
+inline double getSigma(const std::vector<FilterParameter>& params)
 {
-    double a;
+    double sigma;
     try
     {
-        a = findParameter("damping-coeff", params);
+        sigma = findParameter("sigma", params);
     }
     catch(NotFound& err)
     {
-        throw(MissingParameter("Missing damping-coeff parameter!"));
+        throw(MissingParameter("Missing sigma parameter!"));
     }
     
-    //copy first element
-    *target = *rangeStart;
-    double memory = (1-a)*(*rangeStart);
-    target = std::next(target, 1);
-    for(auto it = std::next(rangeStart, 1); it<rangeEnd; std::advance(it, 1))
+    //the recursive approximation is fitted down to 0.5, above 10000 its poles get too close to 1 for double precision
+    if(!(sigma >= 0.5 && sigma <= 10000))
+        throw(InvalidParameter("Gaussian sigma must be between 0.5 and 10000!"));
+    
+    return sigma;
+}
+
+/**
+ * @brief Read resampling factor parameter.
+ * @param paramName Parameter name.
+ * @param params Parameters.
+ * @return Factor. 1 if the parameter is not provided.
+ * @throw InvalidParameter If the factor is not a positive integer.
+ */
+inline size_t getFactor(const std::string& paramName, const std::vector<FilterParameter>& params)
+{
+    double factor;
+    try
+    {
+        factor = findParameter(paramName, params);
+    }
+    catch(NotFound& err)
     {
-        *target = (a*(*it)) + memory;
-        memory = (1-a)*(*it);
-        std::advance(target, 1);
+        return 1;
     }
+    
+    if(factor < 1 || factor != std::floor(factor))
+        throw(InvalidParameter("Resampling factors must be positive integers!"));
+    
+    return factor;
 }
 
 /**
- * @brief Moving average filter. Will apply filter between < rangeStart, rangeEnd),
- * @param target Start of the range where we suppose to put the results.
- * @param rangeStart Start the signal.
- * @param rangeEnd End of the signal.
+ * @brief Read polynomial or derivative order parameter.
+ * @param paramName Parameter name.
  * @param params Parameters.
- * @throw MissingParameter If required parameters are not provided.
+ * @return Order.
+ * @throw NotFound If the parameter is not on the list.
+ * @throw InvalidParameter If the order is not a non negative integer.
+ */
+inline size_t getOrder(const std::string& paramName, const std::vector<FilterParameter>& params)
+{
+    const double order = findParameter(paramName, params);
+    if(order < 0 || order != std::floor(order))
+        throw(InvalidParameter("Polynomial and derivative orders must be non negative integers!"));
+    
+    return order;
+}
+
+/**
+ * @brief Load FIR filter coefficients from the .npy file named by the coefficients parameter.
+ * @param params Parameters.
+ * @return Coefficients.
+ * @throw MissingParameter If coefficients are not provided.
+ * @throw InvalidParameter If the file does not hold a non empty one dimensional array.
+ * @throw std::runtime_error If the file can't be read.
  */
-void median_filter(std::vector<double>::iterator target, std::vector<double>::iterator rangeStart, std::vector<double>::iterator rangeEnd, const std::vector<FilterParameter>& params)
+inline std::vector<double> getCoefficients(const std::vector<FilterParameter>& params)
 {
-    size_t blockSize;
+    std::string fileName;
     try
     {
-        blockSize = findParameter("block-size", params);
+        fileName = findTextParameter("coefficients", params);
     }
     catch(NotFound& err)
     {
-        throw(MissingParameter("Missing block-size parameter!"));
+        throw(MissingParameter("Missing coefficients parameter!"));
     }
+    
+    const NpyHeader header = readNpyHeader(fileName);
+    validateSignalHeader(header);
+    if(header.shape.size() != 1 || header.shape[0] == 0)
+        throw(InvalidParameter("Coefficients must be a non empty one dimensional array!"));
+    
+    return loadSignal<double>(fileName);
+}
 
-    std::vector<double> sortBuffer(blockSize);
-    bool isOdd = blockSize%2;
-    for(auto it = rangeStart; it<std::prev(rangeEnd, blockSize); std::advance(it, 1))
+/**
+ * @brief Load second order sections from the .npy file named by the coefficients parameter.
+ * File holds a [sections, 6] array, every row is b0, b1, b2, a0, a1, a2 (layout used by scipy.signal).
+ * @param params Parameters.
+ * @return b0, b1, b2, a1, a2 of every section, normalised by a0.
+ * @throw MissingParameter If coefficients are not provided.
+ * @throw InvalidParameter If the file does not hold a non empty [sections, 6] array or some a0 is zero.
+ * @throw std::runtime_error If the file can't be read.
+ */
+inline std::vector<double> getSections(const std::vector<FilterParameter>& params)
+{
+    std::string fileName;
+    try
     {
-        std::copy(it, std::next(it, blockSize), std::begin(sortBuffer));
-        std::sort(std::begin(sortBuffer), std::end(sortBuffer));
-        if(isOdd)
-           *target = sortBuffer[(blockSize/2)+1];
+        fileName = findTextParameter("coefficients", params);
+    }
+    catch(NotFound& err)
+    {
+        throw(MissingParameter("Missing coefficients parameter!"));
+    }
+    
+    const NpyHeader header = readNpyHeader(fileName);
+    validateSignalHeader(header);
+    if(header.shape.size() != 2 || header.shape[0] == 0 || header.shape[1] != 6)
+        throw(InvalidParameter("Second order sections must be a non empty [sections, 6] array!"));
+    
+    const size_t sections = header.shape[0];
+    const std::vector<double> rows = loadSignal<double>(fileName);
+    std::vector<double> coefficients;
+    for(size_t s=0; s<sections; s++)
+    {
+        //element (s, j) of the array
+        const auto at = [&](size_t j){ return header.fortranOrder ? rows[j*sections + s] : rows[6*s + j]; };
+        const double a0 = at(3);
+        if(a0 == 0)
+            throw(InvalidParameter("Coefficient a0 of every section must be non zero!"));
+        
+        for(size_t j : {0, 1, 2, 4, 5})
+            coefficients.push_back(at(j)/a0);
+    }
+    
+    return coefficients;
+}
+
+/**
+ * @brief Parse moving average parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ */
+MovingAverageParameters MovingAverage::parse(const std::vector<FilterParameter>& params)
+{
+    return {getBlockSize(params), getFactor("down-factor", params)};
+}
+
+/**
+ * @brief Output rate of the moving average filter.
+ * @param params Parameters.
+ * @return One output sample every decimation input samples.
+ */
+Rate MovingAverage::rate(const Parameters& params)
+{
+    return {1, params.decimation};
+}
+
+/**
+ * @brief Halo of the moving average filter.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo MovingAverage::halo(const Parameters& params)
+{
+    return {params.blockSize-1, 0};
+}
+
+/**
+ * @brief Moving average filter.
+ * Window sum is updated in O(1) per sample and recomputed from scratch periodically,
+ * so rounding drift stays bounded however long the signal is. Long windows are split
+ * into independent lanes by the vectorised kernel picked at run time.
+ * Decimated windows are summed from scratch, one per lane, when they overlap little,
+ * otherwise the sum slides by decimation samples from one kept window to the next.
+ * @param target Start of the range where we suppose to put the results.
+ * @param firstOutput Index of the first output sample.
+ * @param count Number of output samples.
+ * @param window Part of the signal to filter.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void MovingAverage::filter(Sample* target, size_t, size_t count, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    const size_t blockSize = params.blockSize;
+    const size_t down = params.decimation;
+    
+    //copy samples with history clipped by the start of the signal
+    const Sample* it = window.begin;
+    size_t i = 0;
+    for(; i<count && static_cast<size_t>(it - window.first) < blockSize-1; i++, it+=down)
+        target[i] = *it;
+    
+    //vectorised kernel slides the sum over every sample or sums spaced out windows from scratch,
+    //which stays cheaper up to windows of 8 decimation periods
+    if(down == 1 || blockSize <= 8*down)
+    {
+        simdKernels<Sample>().movingAverage(it, count-i, blockSize, down, target+i);
+        return;
+    }
+    
+    SlidingSum sum(blockSize);
+    for(; i<count; i++, it+=down)
+    {
+        if(sum.stale())
+            sum.resum(it-(blockSize-1), it+1);
+        else
+        {
+            //slide the window from the previous kept sample
+            for(const Sample* x=it-(down-1); x<=it; x++)
+                sum.slide(*x, *(x-blockSize));
+        }
+        target[i] = static_cast<Sample>(sum.value()/blockSize);
+    }
+}
+
+/**
+ * @brief Parse moving average parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ */
+MovingAverageParameters MovingAverageReference::parse(const std::vector<FilterParameter>& params)
+{
+    return MovingAverage::parse(params);
+}
+
+/**
+ * @brief Output rate of the moving average filter.
+ * @param params Parameters.
+ * @return One output sample every decimation input samples.
+ */
+Rate MovingAverageReference::rate(const Parameters& params)
+{
+    return MovingAverage::rate(params);
+}
+
+/**
+ * @brief Halo of the moving average filter.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo MovingAverageReference::halo(const Parameters& params)
+{
+    return MovingAverage::halo(params);
+}
+
+/**
+ * @brief Reference moving average filter.
+ * @param target Start of the range where we suppose to put the results.
+ * @param firstOutput Index of the first output sample.
+ * @param count Number of output samples.
+ * @param window Part of the signal to filter.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void MovingAverageReference::filter(Sample* target, size_t, size_t, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    const size_t blockSize = params.blockSize;
+    
+    for(const Sample* it=window.begin; it<window.end; it+=params.decimation)
+    {
+        //history clipped by the start of the signal
+        if(static_cast<size_t>(it - window.first) < blockSize-1)
+            *target++ = *it;
         else
-           *target = ((sortBuffer[(blockSize/2)]) + (sortBuffer[(blockSize/2)+1]))/2;
+            *target++ = static_cast<Sample>(std::accumulate(it-(blockSize-1), it+1, 0.0)/blockSize);
+    }
+}
+
+/**
+ * @brief Parse exponential filter parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ */
+ExponentialParameters Exponential::parse(const std::vector<FilterParameter>& params)
+{
+    return {getDampingCoeff(params), getFactor("down-factor", params)};
+}
+
+/**
+ * @brief Output rate of the exponential filter.
+ * @param params Parameters.
+ * @return One output sample every decimation input samples.
+ */
+Rate Exponential::rate(const Parameters& params)
+{
+    return {1, params.decimation};
+}
+
+/**
+ * @brief State before the first sample. Filter starts as if it had seen the first sample forever.
+ * @param signal Signal.
+ * @return Initial state.
+ */
+template<typename Sample>
+double Exponential::initialState(const Sample* signal, const Parameters&)
+{
+    return signal[0];
+}
 
+/**
+ * @brief State of the filter at rest.
+ * @return Zero state.
+ */
+double Exponential::zeroState(const Parameters&)
+{
+    return 0;
+}
+
+/**
+ * @brief Exponential filter recurrence. Computed in double precision whatever the sample type.
+ * @param input Input samples.
+ * @param count Number of samples.
+ * @param output Output samples, one every decimation input samples starting with the first one.
+ * @param state Previous output sample.
+ * @param params Parameters.
+ * @return Last output sample.
+ */
+template<typename Sample>
+double Exponential::run(const Sample* input, size_t count, Sample* output, double state, const Parameters& params)
+{
+    const double a = params.dampingCoeff;
+    const double b = 1-a;
+    const size_t down = params.decimation;
+    
+    for(size_t i=0; i<count; i+=down)
+    {
+        state = a*input[i] + b*state;
+        *output++ = static_cast<Sample>(state);
         
-        std::advance(target, 1);
+        //samples between the kept ones only advance the state
+        const size_t skipEnd = std::min(i+down, count);
+        for(size_t j=i+1; j<skipEnd; j++)
+            state = a*input[j] + b*state;
+    }
+    
+    return state;
+}
+
+/**
+ * @brief Propagate the state over count samples.
+ * With zero input the state decays by (1-a) every sample.
+ * @param local Final state of the range filtered from zero state.
+ * @param incoming State before the range.
+ * @param count Length of the range.
+ * @param params Parameters.
+ * @return Final state of the range.
+ */
+double Exponential::carry(double local, double incoming, size_t count, const Parameters& params)
+{
+    return local + std::pow(1-params.dampingCoeff, static_cast<double>(count))*incoming;
+}
+
+/**
+ * @brief Add decay of the incoming state, (1-a)^(i+1)*incoming, to the output.
+ * Lanes advance by (1-a)^lanes so there is no dependency between neighbouring samples.
+ * Runs the vectorised kernel picked at run time. Decimated output is corrected only
+ * at the kept samples, which decay by (1-a)^decimation from one to the next.
+ * @param output Output computed from zero state.
+ * @param count Number of input samples.
+ * @param incoming State before the range.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void Exponential::correct(Sample* output, size_t count, double incoming, const Parameters& params)
+{
+    const double decay = 1-params.dampingCoeff;
+    const size_t down = params.decimation;
+    if(down == 1)
+    {
+        simdKernels<Sample>().exponentialCorrect(output, count, incoming, decay);
+        return;
     }
     
-    //copy last block size elements
-    std::copy(std::prev(rangeEnd, blockSize), rangeEnd, target);
+    const size_t kept = (count + down - 1)/down;
+    output[0] += static_cast<Sample>(decay*incoming);
+    simdKernels<Sample>().exponentialCorrect(output+1, kept-1, decay*incoming, std::pow(decay, static_cast<double>(down)));
+}
+
+/**
+ * @brief Parse median filter parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ */
+MedianParameters Median::parse(const std::vector<FilterParameter>& params)
+{
+    return {getBlockSize(params), getFactor("down-factor", params)};
+}
+
+/**
+ * @brief Output rate of the median filter.
+ * @param params Parameters.
+ * @return One output sample every decimation input samples.
+ */
+Rate Median::rate(const Parameters& params)
+{
+    return {1, params.decimation};
+}
+
+/**
+ * @brief Halo of the median filter.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo Median::halo(const Parameters& params)
+{
+    return {0, params.blockSize-1};
+}
+
+/**
+ * @brief Median filter.
+ * Small windows are handled by sorting networks, larger ones are slid through
+ * a SlidingMedian, which costs O(log blockSize) per sample. Decimated windows skip
+ * ahead by replacing decimation samples, or are selected from scratch once selection
+ * gets cheaper. Selecting a window costs about as much as sliding it by blockSize/16
+ * samples (measured for windows of 101 and 1001 samples). Every path orders samples
+ * by medianLess, so NaN counts as larger than any number.
+ * @param target Start of the range where we suppose to put the results.
+ * @param firstOutput Index of the first output sample.
+ * @param count Number of output samples.
+ * @param window Part of the signal to filter.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void Median::filter(Sample* target, size_t, size_t count, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    const size_t blockSize = params.blockSize;
+    const size_t down = params.decimation;
+
+    //samples with the full window available
+    const size_t available = window.last - window.begin;
+    const size_t fullCount = available < blockSize ? 0 : std::min<size_t>((available - blockSize)/down + 1, count);
+    
+    if(isMedianNetworkSize(blockSize))
+        medianNetwork_filter(blockSize, window.begin, fullCount, target, down);
+    else if(fullCount > 0 && blockSize > 16*down)
+    {
+        SlidingMedian median(blockSize);
+        std::for_each(window.begin, window.begin+blockSize, [&median](Sample x){ median.push(x); });
+        
+        target[0] = static_cast<Sample>(median.median());
+        for(size_t i=1; i<fullCount; i++)
+        {
+            const Sample* incoming = window.begin + (i-1)*down + blockSize;
+            for(size_t j=0; j<down; j++)
+                median.push(incoming[j]);
+            target[i] = static_cast<Sample>(median.median());
+        }
+    }
+    else if(fullCount > 0)
+    {
+        thread_local std::vector<Sample> selection;
+        selection.resize(blockSize);
+        const auto middle = selection.begin() + blockSize/2;
+        for(size_t i=0; i<fullCount; i++)
+        {
+            const Sample* start = window.begin + i*down;
+            std::copy(start, start+blockSize, selection.begin());
+            std::nth_element(selection.begin(), middle, selection.end(), medianLess<Sample>);
+            
+            //even window takes the mean of the two middle samples, the lower one is the largest before the middle
+            if(blockSize%2)
+                target[i] = *middle;
+            else
+                target[i] = static_cast<Sample>((static_cast<double>(*std::max_element(selection.begin(), middle, medianLess<Sample>)) + *middle)/2);
+        }
+    }
+
+    //window clipped by the end of the signal
+    for(size_t i=fullCount; i<count; i++)
+        target[i] = window.begin[i*down];
+}
+
+/**
+ * @brief Parse median filter parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ */
+MedianParameters MedianReference::parse(const std::vector<FilterParameter>& params)
+{
+    return Median::parse(params);
+}
+
+/**
+ * @brief Output rate of the median filter.
+ * @param params Parameters.
+ * @return One output sample every decimation input samples.
+ */
+Rate MedianReference::rate(const Parameters& params)
+{
+    return Median::rate(params);
+}
+
+/**
+ * @brief Halo of the median filter.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo MedianReference::halo(const Parameters& params)
+{
+    return Median::halo(params);
+}
+
+/**
+ * @brief Reference median filter.
+ * @param target Start of the range where we suppose to put the results.
+ * @param firstOutput Index of the first output sample.
+ * @param count Number of output samples.
+ * @param window Part of the signal to filter.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void MedianReference::filter(Sample* target, size_t, size_t, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    const size_t blockSize = params.blockSize;
+
+    std::vector<Sample> sortBuffer(blockSize);
+    bool isOdd = blockSize%2;
+    for(const Sample* it = window.begin; it<window.end; it+=params.decimation)
+    {
+        //window clipped by the end of the signal
+        if(static_cast<size_t>(window.last - it) < blockSize)
+        {
+            *target++ = *it;
+            continue;
+        }
+        
+        std::copy(it, it+blockSize, std::begin(sortBuffer));
+        std::sort(std::begin(sortBuffer), std::end(sortBuffer), medianLess<Sample>);
+        if(isOdd)
+           *target = sortBuffer[blockSize/2];
+        else
+           *target = ((sortBuffer[(blockSize/2)-1]) + (sortBuffer[blockSize/2]))/2;
+
+        target++;
+    }
 }
+
+/**
+ * @brief Prepare FIR filter for the coefficients.
+ * @param taps Filter coefficients, taps[0] weights the newest sample.
+ * @param method Convolution method: auto, direct or fft.
+ * @return Typed parameters, with the transform of the coefficients if FFT convolution is used.
+ */
+static FirParameters firParameters(std::vector<double> taps, const std::string& method)
+{
+    FirParameters typed = {std::move(taps), nullptr, method == "fft", {}, {}};
+    const size_t tapCount = typed.taps.size();
+    
+    //sample type is not known yet, so the transform is prepared if either type may use it
+    const size_t crossover = std::min(simdKernels<double>().firFftCrossover, simdKernels<float>().firFftCrossover);
+    if(typed.fftForced || (method == "auto" && tapCount >= crossover))
+    {
+        //every transform yields size-taps+1 outputs, 4x taps keeps most of it useful
+        //and short transforms would spend most of their time on call overhead
+        auto fft = std::make_shared<Fft>(std::max<size_t>(fftSizeFor(4*tapCount), FIR_MIN_FFT_SIZE));
+        typed.spectrumReal.assign(fft->size(), 0);
+        typed.spectrumImag.assign(fft->size(), 0);
+        std::copy(typed.taps.begin(), typed.taps.end(), typed.spectrumReal.begin());
+        fft->forward(typed.spectrumReal.data(), typed.spectrumImag.data());
+        typed.fft = fft;
+    }
+    
+    return typed;
+}
+
+/**
+ * @brief Parse FIR filter parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ */
+FirParameters Fir::parse(const std::vector<FilterParameter>& params)
+{
+    std::string method = "auto";
+    try
+    {
+        method = findTextParameter("fir-method", params);
+    }
+    catch(NotFound& err)
+    {
+    }
+    if(method != "auto" && method != "direct" && method != "fft")
+        throw(InvalidParameter("FIR method must be auto, direct or fft!"));
+    
+    return firParameters(getCoefficients(params), method);
+}
+
+/**
+ * @brief Halo of the FIR filter.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo Fir::halo(const Parameters& params)
+{
+    return {params.taps.size()-1, 0};
+}
+
+/**
+ * @brief Overlap-save FFT convolution of the window.
+ * Every block of size-taps+1 outputs needs one transform of its input and the taps-1
+ * samples before it. Two blocks go through every transform, one in the real part and
+ * the next one in the imaginary part, since the coefficients are real.
+ * @param target Start of the range where we suppose to put the results.
+ * @param window Part of the signal to filter.
+ * @param params Parameters.
+ */
+template<typename Sample>
+static void firOverlapSave(Sample* target, const SignalWindow<Sample>& window, const FirParameters& params)
+{
+    const Fft& fft = *params.fft;
+    const size_t n = fft.size();
+    const size_t history = params.taps.size()-1;
+    const size_t step = n - history;
+    const ptrdiff_t available = window.last - window.first;
+    
+    //sample of the signal or zero outside of it
+    const auto sample = [&window, available](ptrdiff_t index) -> double
+    {
+        return (index >= 0 && index < available) ? static_cast<double>(window.first[index]) : 0.0;
+    };
+    
+    thread_local std::vector<double> real;
+    thread_local std::vector<double> imag;
+    real.resize(n);
+    imag.resize(n);
+    for(const Sample* it=window.begin; it<window.end; it+=2*step)
+    {
+        const ptrdiff_t start = (it - window.first) - static_cast<ptrdiff_t>(history);
+        for(size_t k=0; k<n; k++)
+        {
+            real[k] = sample(start+k);
+            imag[k] = sample(start+step+k);
+        }
+        
+        fft.forward(real.data(), imag.data());
+        for(size_t k=0; k<n; k++)
+        {
+            const double xr = real[k];
+            const double xi = imag[k];
+            real[k] = xr*params.spectrumReal[k] - xi*params.spectrumImag[k];
+            imag[k] = xr*params.spectrumImag[k] + xi*params.spectrumReal[k];
+        }
+        fft.inverse(real.data(), imag.data());
+        
+        //first taps-1 outputs of every block wrap around and are dropped
+        const size_t firstCount = std::min<size_t>(step, window.end - it);
+        for(size_t k=0; k<firstCount; k++)
+            *target++ = static_cast<Sample>(real[history+k]);
+        const size_t secondCount = std::min<size_t>(step, window.end - it - firstCount);
+        for(size_t k=0; k<secondCount; k++)
+            *target++ = static_cast<Sample>(imag[history+k]);
+    }
+}
+
+/**
+ * @brief FIR filter.
+ * Filters from the crossover of the selected kernels on go through overlap-save FFT convolution. For shorter ones neighbouring outputs
+ * are accumulated in vector registers over all taps at once by the vectorised kernel picked at run time.
+ * @param target Start of the range where we suppose to put the results.
+ * @param window Part of the signal to filter.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void Fir::filter(Sample* target, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    if(params.fft && (params.fftForced || params.taps.size() >= simdKernels<Sample>().firFftCrossover))
+    {
+        firOverlapSave(target, window, params);
+        return;
+    }
+    
+    const std::vector<double>& taps = params.taps;
+    
+    //history clipped by the start of the signal, taps in the same order as in the kernel
+    const Sample* it = window.begin;
+    for(; it<window.end && static_cast<size_t>(it - window.first) < taps.size()-1; it++)
+    {
+        Sample sum = 0;
+        for(size_t j=0; j<=static_cast<size_t>(it - window.first); j++)
+            sum += static_cast<Sample>(taps[j]) * *(it-j);
+        *target++ = sum;
+    }
+    
+    simdKernels<Sample>().fir(it, window.end - it, taps.data(), taps.size(), target);
+}
+
+/**
+ * @brief Parse FIR filter parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ */
+FirParameters FirReference::parse(const std::vector<FilterParameter>& params)
+{
+    return {getCoefficients(params), nullptr, false, {}, {}};
+}
+
+/**
+ * @brief Halo of the FIR filter.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo FirReference::halo(const Parameters& params)
+{
+    return Fir::halo(params);
+}
+
+/**
+ * @brief Reference FIR filter.
+ * @param target Start of the range where we suppose to put the results.
+ * @param window Part of the signal to filter.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void FirReference::filter(Sample* target, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    const std::vector<double>& taps = params.taps;
+    
+    for(const Sample* it=window.begin; it<window.end; it++)
+    {
+        //samples before the start of the signal are zero
+        const size_t available = std::min<size_t>(it - window.first + 1, taps.size());
+        double sum = 0;
+        for(size_t j=0; j<available; j++)
+            sum += taps[j] * *(it-j);
+        *target++ = static_cast<Sample>(sum);
+    }
+}
+
+/**
+ * @brief Get coefficients of the Savitzky-Golay filter. They are computed on first use and kept
+ * for the rest of the process, so every call and every batch run with the same window and orders
+ * shares them.
+ * @param window Number of fitted samples.
+ * @param polyOrder Order of the fitted polynomial.
+ * @param derivOrder Order of the derivative.
+ * @return Coefficients.
+ */
+static std::shared_ptr<const SavitzkyGolayCoefficients> savitzkyGolayCoefficients(size_t window, size_t polyOrder, size_t derivOrder)
+{
+    static std::mutex cacheMutex;
+    static std::map<std::array<size_t, 3>, std::shared_ptr<const SavitzkyGolayCoefficients>> cache;
+    
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::shared_ptr<const SavitzkyGolayCoefficients>& cached = cache[{window, polyOrder, derivOrder}];
+    if(!cached)
+    {
+        auto coefficients = std::make_shared<SavitzkyGolayCoefficients>();
+        coefficients->fits = polynomialFitWeights(window, polyOrder, derivOrder);
+        
+        //centre row reversed, so the newest sample of the window comes first
+        const double* centre = coefficients->fits.data() + (window/2)*window;
+        coefficients->centre = firParameters(std::vector<double>(std::make_reverse_iterator(centre+window), std::make_reverse_iterator(centre)), "auto");
+        cached = coefficients;
+    }
+    
+    return cached;
+}
+
+/**
+ * @brief Weighted sum of samples in double precision.
+ * @param weights Weights.
+ * @param samples First sample.
+ * @param count Number of samples.
+ * @return Sum.
+ */
+template<typename Sample>
+static inline double weightedSum(const double* weights, const Sample* samples, size_t count)
+{
+    double sum = 0;
+    for(size_t k=0; k<count; k++)
+        sum += weights[k]*samples[k];
+    return sum;
+}
+
+/**
+ * @brief Parse Savitzky-Golay filter parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ * @throw InvalidParameter If the window is even or the orders don't fit into it.
+ */
+SavitzkyGolayParameters SavitzkyGolay::parse(const std::vector<FilterParameter>& params)
+{
+    const size_t window = getBlockSize(params);
+    size_t polyOrder;
+    try
+    {
+        polyOrder = getOrder("poly-order", params);
+    }
+    catch(NotFound& err)
+    {
+        throw(MissingParameter("Missing poly-order parameter!"));
+    }
+    
+    size_t derivOrder = 0;
+    try
+    {
+        derivOrder = getOrder("deriv-order", params);
+    }
+    catch(NotFound& err)
+    {
+    }
+    
+    if(window%2 == 0)
+        throw(InvalidParameter("Savitzky-Golay window must be odd!"));
+    if(polyOrder >= window)
+        throw(InvalidParameter("Polynomial order must be smaller than the window!"));
+    if(derivOrder > polyOrder)
+        throw(InvalidParameter("Derivative order can't exceed polynomial order!"));
+    
+    return {window, polyOrder, derivOrder, savitzkyGolayCoefficients(window, polyOrder, derivOrder)};
+}
+
+/**
+ * @brief Halo of the Savitzky-Golay filter.
+ * Outputs near the signal edges are fitted to the whole first or last window,
+ * so they reach up to window-1 samples away.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo SavitzkyGolay::halo(const Parameters& params)
+{
+    return {params.window-1, params.window-1};
+}
+
+/**
+ * @brief Savitzky-Golay filter.
+ * Outputs with the whole window inside the signal go through the FIR kernel, shifted by half
+ * of the window, the ones near the edges weight the first or last window in double precision.
+ * @param target Start of the range where we suppose to put the results.
+ * @param window Part of the signal to filter.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void SavitzkyGolay::filter(Sample* target, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    const size_t size = params.window;
+    const size_t half = size/2;
+    const size_t readable = window.last - window.first;
+    const double* fits = params.coefficients->fits.data();
+    
+    //signal shorter than the window, both of its ends are readable
+    if(readable < size)
+    {
+        const std::vector<double> whole = polynomialFitWeights(readable, std::min(params.polyOrder, readable-1), params.derivOrder);
+        for(const Sample* it=window.begin; it<window.end; it++)
+            *target++ = static_cast<Sample>(weightedSum(whole.data() + (it-window.first)*readable, window.first, readable));
+        return;
+    }
+    
+    //window clipped by the start of the signal
+    const Sample* it = window.begin;
+    for(; it<window.end && static_cast<size_t>(it - window.first) < half; it++)
+        *target++ = static_cast<Sample>(weightedSum(fits + (it-window.first)*size, window.first, size));
+    
+    //whole window inside the signal, output i is the FIR output at sample i+half
+    const Sample* centreEnd = std::max(it, std::min(window.end, window.last - half));
+    if(centreEnd > it)
+        Fir::filter(target, SignalWindow<Sample>{window.first, it+half, centreEnd+half, window.last}, params.coefficients->centre);
+    target += centreEnd - it;
+    
+    //window clipped by the end of the signal
+    const Sample* lastWindow = window.last - size;
+    for(it=centreEnd; it<window.end; it++)
+        *target++ = static_cast<Sample>(weightedSum(fits + (it-lastWindow)*size, lastWindow, size));
+}
+
+/**
+ * @brief Parse Savitzky-Golay filter parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ * @throw InvalidParameter If the window is even or the orders don't fit into it.
+ */
+SavitzkyGolayParameters SavitzkyGolayReference::parse(const std::vector<FilterParameter>& params)
+{
+    return SavitzkyGolay::parse(params);
+}
+
+/**
+ * @brief Halo of the Savitzky-Golay filter.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo SavitzkyGolayReference::halo(const Parameters& params)
+{
+    return SavitzkyGolay::halo(params);
+}
+
+/**
+ * @brief Reference Savitzky-Golay filter.
+ * @param target Start of the range where we suppose to put the results.
+ * @param window Part of the signal to filter.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void SavitzkyGolayReference::filter(Sample* target, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    const size_t size = params.window;
+    const size_t readable = window.last - window.first;
+    const std::vector<double> fits = readable < size ? polynomialFitWeights(readable, std::min(params.polyOrder, readable-1), params.derivOrder) : params.coefficients->fits;
+    const size_t fitted = std::min(size, readable);
+    
+    for(const Sample* it=window.begin; it<window.end; it++)
+    {
+        //window centred on the sample, moved inside the signal at its edges
+        const size_t offset = it - window.first;
+        const size_t start = std::min(offset - std::min(offset, fitted/2), readable - fitted);
+        *target++ = static_cast<Sample>(weightedSum(fits.data() + (offset-start)*fitted, window.first + start, fitted));
+    }
+}
+
+/**
+ * @brief Advance the biquad cascade by one sample.
+ * Same arithmetic as the vectorised kernel, so both paths give identical results.
+ * @param x Input sample.
+ * @param state s1 and s2 of every section. Updated.
+ * @param params Parameters.
+ * @return Output sample.
+ */
+static inline double biquadStep(double x, double* state, const BiquadParameters& params)
+{
+    for(size_t s=0; s<params.sections; s++)
+    {
+        const double* c = params.coefficients.data() + 5*s;
+        double* s1 = state + 2*s;
+        double* s2 = s1 + 1;
+        const double y = c[0]*x + *s1;
+        *s1 = (c[1]*x + *s2) - c[3]*y;
+        *s2 = c[2]*x - c[4]*y;
+        x = y;
+    }
+    
+    return x;
+}
+
+/**
+ * @brief Parse biquad cascade parameters.
+ * State transition matrix is found by advancing every unit state by one sample of zero input.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ * @throw InvalidParameter If the sections are malformed.
+ */
+BiquadParameters BiquadCascade::parse(const std::vector<FilterParameter>& params)
+{
+    BiquadParameters typed;
+    typed.coefficients = getSections(params);
+    typed.sections = typed.coefficients.size()/5;
+    
+    const size_t order = 2*typed.sections;
+    typed.transition.assign(order*order, 0);
+    for(size_t j=0; j<order; j++)
+    {
+        std::vector<double> state(order, 0);
+        state[j] = 1;
+        biquadStep(0, state.data(), typed);
+        for(size_t i=0; i<order; i++)
+            typed.transition[i*order + j] = state[i];
+    }
+    
+    return typed;
+}
+
+/**
+ * @brief State before the first sample. Filter starts in the steady state for the first sample,
+ * as if it had seen it forever. Cascades with a pole at z = 1 have no such state and start from rest.
+ * @param signal Signal.
+ * @param params Parameters.
+ * @return Initial state.
+ */
+template<typename Sample>
+BiquadCascade::State BiquadCascade::initialState(const Sample* signal, const Parameters& params)
+{
+    State state = zeroState(params);
+    double x = signal[0];
+    for(size_t s=0; s<params.sections; s++)
+    {
+        const double* c = params.coefficients.data() + 5*s;
+        const double poles = 1 + c[3] + c[4];
+        if(poles == 0)
+            return zeroState(params);
+        
+        //constant input passes with the DC gain of the section
+        const double y = x*(c[0] + c[1] + c[2])/poles;
+        state[2*s+1] = c[2]*x - c[4]*y;
+        state[2*s] = c[1]*x - c[3]*y + state[2*s+1];
+        x = y;
+    }
+    
+    return state;
+}
+
+/**
+ * @brief State of the filter at rest.
+ * @param params Parameters.
+ * @return Zero state.
+ */
+BiquadCascade::State BiquadCascade::zeroState(const Parameters& params)
+{
+    return State(2*params.sections, 0);
+}
+
+/**
+ * @brief Biquad cascade recurrence. Computed in double precision whatever the sample type.
+ * @param input Input samples.
+ * @param count Number of samples.
+ * @param output Output samples.
+ * @param state State before the first sample.
+ * @param params Parameters.
+ * @return State after the last sample.
+ */
+template<typename Sample>
+BiquadCascade::State BiquadCascade::run(const Sample* input, size_t count, Sample* output, State state, const Parameters& params)
+{
+    for(size_t i=0; i<count; i++)
+        output[i] = static_cast<Sample>(biquadStep(input[i], state.data(), params));
+    
+    return state;
+}
+
+/**
+ * @brief Propagate the state over count samples.
+ * With zero input the state is multiplied by the transition matrix every sample,
+ * its count-th power is applied by repeated squaring.
+ * @param local Final state of the range filtered from zero state.
+ * @param incoming State before the range.
+ * @param count Length of the range.
+ * @param params Parameters.
+ * @return Final state of the range.
+ */
+BiquadCascade::State BiquadCascade::carry(State local, State incoming, size_t count, const Parameters& params)
+{
+    const size_t order = 2*params.sections;
+    std::vector<double> power = params.transition;
+    std::vector<double> product(order*order);
+    State next(order);
+    while(count)
+    {
+        if(count & 1)
+        {
+            for(size_t i=0; i<order; i++)
+                next[i] = std::inner_product(power.begin()+i*order, power.begin()+(i+1)*order, incoming.begin(), 0.0);
+            incoming.swap(next);
+        }
+        
+        count >>= 1;
+        if(count)
+        {
+            for(size_t i=0; i<order; i++)
+            {
+                for(size_t j=0; j<order; j++)
+                {
+                    double sum = 0;
+                    for(size_t k=0; k<order; k++)
+                        sum += power[i*order + k]*power[k*order + j];
+                    product[i*order + j] = sum;
+                }
+            }
+            power.swap(product);
+        }
+    }
+    
+    for(size_t i=0; i<order; i++)
+        local[i] += incoming[i];
+    return local;
+}
+
+/**
+ * @brief Add response to the incoming state, i.e. the cascade run on zero input, to the output.
+ * Response of a stable cascade decays, it is dropped once the state gets subnormal,
+ * which would otherwise slow every following sample down many times.
+ * @param output Output computed from zero state.
+ * @param count Number of samples.
+ * @param incoming State before the range.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void BiquadCascade::correct(Sample* output, size_t count, State incoming, const Parameters& params)
+{
+    const size_t CHECK_INTERVAL = 64;
+    const auto negligible = [](double x){ return std::abs(x) < std::numeric_limits<double>::min(); };
+    
+    for(size_t start=0; start<count; start+=CHECK_INTERVAL)
+    {
+        if(std::all_of(incoming.begin(), incoming.end(), negligible))
+            return;
+        
+        const size_t end = std::min(start+CHECK_INTERVAL, count);
+        for(size_t i=start; i<end; i++)
+            output[i] = static_cast<Sample>(output[i] + biquadStep(0, incoming.data(), params));
+    }
+}
+
+/**
+ * @brief Biquad cascade over up to LANES channels at once.
+ * Samples are interleaved in short blocks, so every step of the recurrence works on
+ * one vector of channels. Runs the vectorised kernel picked at run time.
+ * @param inputs Input samples of every channel.
+ * @param count Number of samples of every channel.
+ * @param outputs Output samples of every channel. May be the same as inputs.
+ * @param channelCount Number of channels, at most LANES.
+ * @param states State of every channel. Updated.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void BiquadCascade::runLanes(const Sample* const* inputs, size_t count, Sample* const* outputs, size_t channelCount, State* states, const Parameters& params)
+{
+    const size_t BLOCK = 256;
+    const size_t order = 2*params.sections;
+    const auto kernel = simdKernels<double>().biquadLanes;
+    
+    //unused lanes filter zeros
+    std::vector<double> state(order*LANES, 0);
+    for(size_t lane=0; lane<channelCount; lane++)
+        for(size_t i=0; i<order; i++)
+            state[i*LANES + lane] = states[lane][i];
+    
+    double samples[BLOCK*LANES] = {};
+    for(size_t start=0; start<count; start+=BLOCK)
+    {
+        const size_t length = std::min(BLOCK, count-start);
+        for(size_t lane=0; lane<channelCount; lane++)
+            for(size_t i=0; i<length; i++)
+                samples[i*LANES + lane] = inputs[lane][start+i];
+        
+        kernel(samples, length, params.coefficients.data(), params.sections, state.data());
+        
+        for(size_t lane=0; lane<channelCount; lane++)
+            for(size_t i=0; i<length; i++)
+                outputs[lane][start+i] = static_cast<Sample>(samples[i*LANES + lane]);
+    }
+    
+    for(size_t lane=0; lane<channelCount; lane++)
+        for(size_t i=0; i<order; i++)
+            states[lane][i] = state[i*LANES + lane];
+}
+
+/**
+ * @brief Invert 3 x 3 matrix by cofactors.
+ * @param matrix Matrix, row major.
+ * @return Inverse, row major.
+ */
+static std::array<std::complex<double>, 9> invert3(const std::array<std::complex<double>, 9>& matrix)
+{
+    const auto at = [&matrix](size_t row, size_t column){ return matrix[(row%3)*3 + column%3]; };
+    std::array<std::complex<double>, 9> inverse;
+    for(size_t i=0; i<3; i++)
+        for(size_t j=0; j<3; j++)
+            inverse[i*3 + j] = at(j+1, i+1)*at(j+2, i+2) - at(j+1, i+2)*at(j+2, i+1);
+    
+    const std::complex<double> determinant = matrix[0]*inverse[0] + matrix[1]*inverse[3] + matrix[2]*inverse[6];
+    for(std::complex<double>& x : inverse)
+        x /= determinant;
+    return inverse;
+}
+
+/**
+ * @brief Parse Gaussian filter parameters.
+ * Coefficients come from the Young and van Vliet fit of the recursive filter to the Gaussian.
+ * Zero input response of the recurrence is a sum of decaying modes, pole^n, so the state is
+ * handled in the basis of the modes, where advancing it by n samples is just a power of every pole.
+ * Repeated squaring of the transition matrix would blow up, as the poles get close to 1 and to each other.
+ * Past the end of the signal the forward pass decays towards the last sample, every mode of the
+ * decay passes the backward filter with gain/(1 - a1*pole - a2*pole^2 - a3*pole^3), which gives the
+ * backward state (Triggs and Sdika boundary).
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If sigma is not provided.
+ * @throw InvalidParameter If sigma is out of range.
+ */
+GaussianParameters Gaussian::parse(const std::vector<FilterParameter>& params)
+{
+    typedef std::complex<double> Complex;
+    GaussianParameters typed;
+    typed.sigma = getSigma(params);
+    
+    //coefficients are expanded from the poles, the published expanded ones lose DC gain for large sigma
+    const double sigma = typed.sigma;
+    const double q = sigma >= 2.5 ? 0.98711*sigma - 0.96330 : 3.97156 - 4.14554*std::sqrt(1 - 0.26891*sigma);
+    const std::array<Complex, 3>& p = typed.poles = {Complex(q/(q + 1.16680)), q/Complex(q + 1.10783, 1.40586), q/Complex(q + 1.10783, -1.40586)};
+    typed.feedback = {(p[0] + p[1] + p[2]).real(), -(p[0]*p[1] + p[0]*p[2] + p[1]*p[2]).real(), (p[0]*p[1]*p[2]).real()};
+    typed.gain = 1 - (typed.feedback[0] + typed.feedback[1] + typed.feedback[2]);
+    
+    //state holds mode weight*pole^2, *pole and *1, newest output first
+    std::array<Complex, 9> modeStates;
+    for(size_t r=0; r<3; r++)
+        for(size_t i=0; i<3; i++)
+            modeStates[r*3 + i] = std::pow(p[i], 2 - static_cast<int>(r));
+    typed.modes = invert3(modeStates);
+    
+    //after the end the oldest output of the state is weight*pole^0, the backward state starts 3 samples later
+    const std::array<double, 3>& a = typed.feedback;
+    for(size_t r=0; r<3; r++)
+    {
+        for(size_t j=0; j<3; j++)
+        {
+            Complex sum = 0;
+            for(size_t i=0; i<3; i++)
+                sum += std::pow(p[i], static_cast<int>(r) + 3)*typed.gain/(1.0 - a[0]*p[i] - a[1]*p[i]*p[i] - a[2]*p[i]*p[i]*p[i])*typed.modes[i*3 + j];
+            typed.boundary[r*3 + j] = sum.real();
+        }
+    }
+    
+    return typed;
+}
+
+/**
+ * @brief State before the first sample. Forward pass starts as if it had seen the first sample forever.
+ * @param signal Signal.
+ * @return Initial state.
+ */
+template<typename Sample>
+Gaussian::State Gaussian::initialState(const Sample* signal, const Parameters&)
+{
+    return {static_cast<double>(signal[0]), static_cast<double>(signal[0]), static_cast<double>(signal[0])};
+}
+
+/**
+ * @brief State of the filter at rest.
+ * @return Zero state.
+ */
+Gaussian::State Gaussian::zeroState(const Parameters&)
+{
+    return {0, 0, 0};
+}
+
+/**
+ * @brief State before the backward pass, as if the last sample went on forever.
+ * @param forward State after the last sample of the forward pass.
+ * @param last Last input sample.
+ * @param params Parameters.
+ * @return State after the last sample for the backward pass.
+ */
+Gaussian::State Gaussian::backwardState(State forward, double last, const Parameters& params)
+{
+    State state;
+    for(size_t i=0; i<3; i++)
+    {
+        state[i] = last;
+        for(size_t j=0; j<3; j++)
+            state[i] += params.boundary[i*3 + j]*(forward[j] - last);
+    }
+    
+    return state;
+}
+
+/**
+ * @brief Third order recurrence of the Gaussian filter in either direction.
+ * @param input Input samples.
+ * @param count Number of samples.
+ * @param output Output samples.
+ * @param state Last three outputs before the range.
+ * @param params Parameters.
+ * @param backward Go from the last sample to the first.
+ * @return Last three outputs of the range.
+ */
+template<typename Sample>
+static inline Gaussian::State gaussianPass(const Sample* input, size_t count, Sample* output, Gaussian::State state, const GaussianParameters& params, bool backward)
+{
+    const double b = params.gain;
+    const double a1 = params.feedback[0];
+    const double a2 = params.feedback[1];
+    const double a3 = params.feedback[2];
+    double y1 = state[0];
+    double y2 = state[1];
+    double y3 = state[2];
+    for(size_t i=0; i<count; i++)
+    {
+        const size_t j = backward ? count-1-i : i;
+        const double y = b*input[j] + a1*y1 + a2*y2 + a3*y3;
+        output[j] = static_cast<Sample>(y);
+        y3 = y2;
+        y2 = y1;
+        y1 = y;
+    }
+    
+    return {y1, y2, y3};
+}
+
+/**
+ * @brief Add response to the incoming state, i.e. the recurrence run on zero input, to the output.
+ * Response decays, it is dropped once the state gets subnormal.
+ * @param output Output computed from zero state.
+ * @param count Number of samples.
+ * @param state State before the range.
+ * @param params Parameters.
+ * @param backward Go from the last sample to the first.
+ */
+template<typename Sample>
+static inline void gaussianDecay(Sample* output, size_t count, Gaussian::State state, const GaussianParameters& params, bool backward)
+{
+    const size_t CHECK_INTERVAL = 64;
+    const auto negligible = [](double x){ return std::abs(x) < std::numeric_limits<double>::min(); };
+    const double a1 = params.feedback[0];
+    const double a2 = params.feedback[1];
+    const double a3 = params.feedback[2];
+    
+    for(size_t start=0; start<count; start+=CHECK_INTERVAL)
+    {
+        if(std::all_of(state.begin(), state.end(), negligible))
+            return;
+        
+        const size_t end = std::min(start+CHECK_INTERVAL, count);
+        for(size_t i=start; i<end; i++)
+        {
+            const size_t j = backward ? count-1-i : i;
+            const double y = a1*state[0] + a2*state[1] + a3*state[2];
+            output[j] = static_cast<Sample>(output[j] + y);
+            state = {y, state[0], state[1]};
+        }
+    }
+}
+
+/**
+ * @brief Forward pass of the Gaussian filter. Computed in double precision whatever the sample type.
+ * @param input Input samples.
+ * @param count Number of samples.
+ * @param output Output samples.
+ * @param state State before the first sample.
+ * @param params Parameters.
+ * @return State after the last sample.
+ */
+template<typename Sample>
+Gaussian::State Gaussian::run(const Sample* input, size_t count, Sample* output, State state, const Parameters& params)
+{
+    return gaussianPass(input, count, output, state, params, false);
+}
+
+/**
+ * @brief Backward pass of the Gaussian filter, from the last sample to the first.
+ * @param input Output of the forward pass.
+ * @param count Number of samples.
+ * @param output Output samples.
+ * @param state State after the last sample.
+ * @param params Parameters.
+ * @return State before the first sample.
+ */
+template<typename Sample>
+Gaussian::State Gaussian::runBackward(const Sample* input, size_t count, Sample* output, State state, const Parameters& params)
+{
+    return gaussianPass(input, count, output, state, params, true);
+}
+
+/**
+ * @brief Propagate the state over count samples. Same in both directions.
+ * Incoming state is split into modes, every mode decays by pole^count.
+ * @param local Final state of the range filtered from zero state.
+ * @param incoming State before the range.
+ * @param count Length of the range.
+ * @param params Parameters.
+ * @return Final state of the range.
+ */
+Gaussian::State Gaussian::carry(State local, State incoming, size_t count, const Parameters& params)
+{
+    std::array<std::complex<double>, 3> weights;
+    for(size_t i=0; i<3; i++)
+    {
+        weights[i] = params.modes[i*3]*incoming[0] + params.modes[i*3 + 1]*incoming[1] + params.modes[i*3 + 2]*incoming[2];
+        weights[i] *= std::pow(params.poles[i], static_cast<double>(count));
+    }
+    
+    for(size_t r=0; r<3; r++)
+        for(size_t i=0; i<3; i++)
+            local[r] += (weights[i]*std::pow(params.poles[i], 2 - static_cast<int>(r))).real();
+    return local;
+}
+
+/**
+ * @brief Add response to the state before the range to the forward pass output.
+ * @param output Output computed from zero state.
+ * @param count Number of samples.
+ * @param incoming State before the range.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void Gaussian::correct(Sample* output, size_t count, State incoming, const Parameters& params)
+{
+    gaussianDecay(output, count, incoming, params, false);
+}
+
+/**
+ * @brief Add response to the state after the range to the backward pass output.
+ * @param output Output computed from zero state.
+ * @param count Number of samples.
+ * @param incoming State after the range.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void Gaussian::correctBackward(Sample* output, size_t count, State incoming, const Parameters& params)
+{
+    gaussianDecay(output, count, incoming, params, true);
+}
+
+/**
+ * @brief Parse resampling filter parameters and split the coefficients into phases.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ * @throw InvalidParameter If the factors are not positive integers.
+ */
+ResamplerParameters Resampler::parse(const std::vector<FilterParameter>& params)
+{
+    ResamplerParameters typed;
+    typed.taps = getCoefficients(params);
+    typed.rate.up = getFactor("up-factor", params);
+    typed.rate.down = getFactor("down-factor", params);
+    const size_t divisor = std::gcd(typed.rate.up, typed.rate.down);
+    typed.rate.up /= divisor;
+    typed.rate.down /= divisor;
+    
+    //taps[phase + j*up] weights the input j samples before the output position
+    const size_t up = typed.rate.up;
+    typed.phaseLength = (typed.taps.size() + up - 1)/up;
+    typed.phases.assign(up*typed.phaseLength, 0);
+    for(size_t k=0; k<typed.taps.size(); k++)
+        typed.phases[(k%up)*typed.phaseLength + typed.phaseLength-1 - k/up] = typed.taps[k];
+    
+    return typed;
+}
+
+/**
+ * @brief Rate of the resampling filter.
+ * @param params Parameters.
+ * @return Output to input sample rate ratio.
+ */
+Rate Resampler::rate(const Parameters& params)
+{
+    return params.rate;
+}
+
+/**
+ * @brief Halo of the resampling filter, in input samples.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo Resampler::halo(const Parameters& params)
+{
+    return {params.phaseLength-1, 0};
+}
+
+/**
+ * @brief Polyphase resampling filter.
+ * Outputs with the whole phase inside the signal run on the vectorised kernel picked at run time.
+ * @param target Start of the range where we suppose to put the results.
+ * @param firstOutput Index of the first output sample.
+ * @param count Number of output samples.
+ * @param window Inputs of the outputs, window.begin is at the position of the first output.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void Resampler::filter(Sample* target, size_t firstOutput, size_t count, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    const Rate& rate = params.rate;
+    const size_t phaseLength = params.phaseLength;
+    const size_t begin = firstOutput*rate.down/rate.up;
+    
+    //history clipped by the start of the signal
+    size_t i = 0;
+    for(; i<count; i++)
+    {
+        const size_t position = (firstOutput+i)*rate.down;
+        const Sample* it = window.begin + (position/rate.up - begin);
+        const size_t available = it - window.first + 1;
+        if(available >= phaseLength)
+            break;
+        
+        const double* phase = params.phases.data() + (position%rate.up)*phaseLength + phaseLength-1;
+        Sample sum = 0;
+        for(size_t j=0; j<available; j++)
+            sum += static_cast<Sample>(*(phase-j)) * *(it-j);
+        target[i] = sum;
+    }
+    if(i == count)
+        return;
+    
+    const size_t position = (firstOutput+i)*rate.down;
+    simdKernels<Sample>().polyphase(window.begin + (position/rate.up - begin), count-i, position%rate.up, rate.up, rate.down,
+                                    params.phases.data(), phaseLength, target+i);
+}
+
+/**
+ * @brief Parse reference resampling filter parameters.
+ * @param params Parameters.
+ * @return Typed parameters.
+ * @throw MissingParameter If required parameters are not provided.
+ * @throw InvalidParameter If the factors are not positive integers.
+ */
+ResamplerParameters ResamplerReference::parse(const std::vector<FilterParameter>& params)
+{
+    return Resampler::parse(params);
+}
+
+/**
+ * @brief Rate of the reference resampling filter.
+ * @param params Parameters.
+ * @return Output to input sample rate ratio.
+ */
+Rate ResamplerReference::rate(const Parameters& params)
+{
+    return Resampler::rate(params);
+}
+
+/**
+ * @brief Halo of the reference resampling filter, in input samples.
+ * @param params Parameters.
+ * @return Halo.
+ */
+Halo ResamplerReference::halo(const Parameters& params)
+{
+    return Resampler::halo(params);
+}
+
+/**
+ * @brief Reference resampling filter.
+ * @param target Start of the range where we suppose to put the results.
+ * @param firstOutput Index of the first output sample.
+ * @param count Number of output samples.
+ * @param window Inputs of the outputs, window.begin is at the position of the first output.
+ * @param params Parameters.
+ */
+template<typename Sample>
+void ResamplerReference::filter(Sample* target, size_t firstOutput, size_t count, const SignalWindow<Sample>& window, const Parameters& params)
+{
+    const size_t up = params.rate.up;
+    const size_t down = params.rate.down;
+    const size_t begin = firstOutput*down/up;
+    
+    for(size_t m=firstOutput; m<firstOutput+count; m++)
+    {
+        //upsampled signal is zero between the input samples and before the start of the signal
+        const size_t position = m*down;
+        double sum = 0;
+        for(size_t k=0; k<params.taps.size() && k<=position; k++)
+        {
+            if((position-k)%up != 0)
+                continue;
+            
+            const ptrdiff_t index = static_cast<ptrdiff_t>((position-k)/up) - static_cast<ptrdiff_t>(begin) + (window.begin - window.first);
+            if(index >= 0)
+                sum += params.taps[k] * window.first[index];
+        }
+        *target++ = static_cast<Sample>(sum);
+    }
+}
+
+template void MovingAverage::filter<double>(double*, size_t, size_t, const SignalWindow<double>&, const Parameters&);
+template void MovingAverage::filter<float>(float*, size_t, size_t, const SignalWindow<float>&, const Parameters&);
+template void MovingAverageReference::filter<double>(double*, size_t, size_t, const SignalWindow<double>&, const Parameters&);
+template void MovingAverageReference::filter<float>(float*, size_t, size_t, const SignalWindow<float>&, const Parameters&);
+template double Exponential::initialState<double>(const double*, const Parameters&);
+template double Exponential::initialState<float>(const float*, const Parameters&);
+template double Exponential::run<double>(const double*, size_t, double*, double, const Parameters&);
+template double Exponential::run<float>(const float*, size_t, float*, double, const Parameters&);
+template void Exponential::correct<double>(double*, size_t, double, const Parameters&);
+template void Exponential::correct<float>(float*, size_t, double, const Parameters&);
+template void Median::filter<double>(double*, size_t, size_t, const SignalWindow<double>&, const Parameters&);
+template void Median::filter<float>(float*, size_t, size_t, const SignalWindow<float>&, const Parameters&);
+template void MedianReference::filter<double>(double*, size_t, size_t, const SignalWindow<double>&, const Parameters&);
+template void MedianReference::filter<float>(float*, size_t, size_t, const SignalWindow<float>&, const Parameters&);
+template void Fir::filter<double>(double*, const SignalWindow<double>&, const Parameters&);
+template void Fir::filter<float>(float*, const SignalWindow<float>&, const Parameters&);
+template void FirReference::filter<double>(double*, const SignalWindow<double>&, const Parameters&);
+template void FirReference::filter<float>(float*, const SignalWindow<float>&, const Parameters&);
+template void SavitzkyGolay::filter<double>(double*, const SignalWindow<double>&, const Parameters&);
+template void SavitzkyGolay::filter<float>(float*, const SignalWindow<float>&, const Parameters&);
+template void SavitzkyGolayReference::filter<double>(double*, const SignalWindow<double>&, const Parameters&);
+template void SavitzkyGolayReference::filter<float>(float*, const SignalWindow<float>&, const Parameters&);
+template BiquadCascade::State BiquadCascade::initialState<double>(const double*, const Parameters&);
+template BiquadCascade::State BiquadCascade::initialState<float>(const float*, const Parameters&);
+template BiquadCascade::State BiquadCascade::run<double>(const double*, size_t, double*, State, const Parameters&);
+template BiquadCascade::State BiquadCascade::run<float>(const float*, size_t, float*, State, const Parameters&);
+template void BiquadCascade::correct<double>(double*, size_t, State, const Parameters&);
+template void BiquadCascade::correct<float>(float*, size_t, State, const Parameters&);
+template void BiquadCascade::runLanes<double>(const double* const*, size_t, double* const*, size_t, State*, const Parameters&);
+template void BiquadCascade::runLanes<float>(const float* const*, size_t, float* const*, size_t, State*, const Parameters&);
+template Gaussian::State Gaussian::initialState<double>(const double*, const Parameters&);
+template Gaussian::State Gaussian::initialState<float>(const float*, const Parameters&);
+template Gaussian::State Gaussian::run<double>(const double*, size_t, double*, State, const Parameters&);
+template Gaussian::State Gaussian::run<float>(const float*, size_t, float*, State, const Parameters&);
+template Gaussian::State Gaussian::runBackward<double>(const double*, size_t, double*, State, const Parameters&);
+template Gaussian::State Gaussian::runBackward<float>(const float*, size_t, float*, State, const Parameters&);
+template void Gaussian::correct<double>(double*, size_t, State, const Parameters&);
+template void Gaussian::correct<float>(float*, size_t, State, const Parameters&);
+template void Gaussian::correctBackward<double>(double*, size_t, State, const Parameters&);
+template void Gaussian::correctBackward<float>(float*, size_t, State, const Parameters&);
+template void Resampler::filter<double>(double*, size_t, size_t, const SignalWindow<double>&, const Parameters&);
+template void Resampler::filter<float>(float*, size_t, size_t, const SignalWindow<float>&, const Parameters&);
+template void ResamplerReference::filter<double>(double*, size_t, size_t, const SignalWindow<double>&, const Parameters&);
+template void ResamplerReference::filter<float>(float*, size_t, size_t, const SignalWindow<float>&, const Parameters&);
@@ -24,8 +24,18 @@
 #define FILTERS_HPP_INCLUDED 
 
 #include <functional>
+#include <string>
 #include <vector>
 #include <exception>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <array>
+#include <complex>
+#include "utils.hpp"
+#include "fft.hpp"
+#include "simd.hpp"
 
 /** 
  * @brief Missing parameter. Thrown
@@ -46,6 +56,25 @@ private:
     const char* message;
 };
 
+/** 
+ * @brief Invalid parameter. Thrown
+ * when filter parameter has value outside of the allowed range.
+ */ 
+class InvalidParameter final : public std::exception
+{
+public:
+    explicit InvalidParameter(const char* message_) noexcept: 
+    message(message_){}
+
+    const char* what() const noexcept override
+    {
+        return message; 
+    }
+
+private:
+    const char* message;
+};
+
 /**
  * @brief Filter parameter.
  */
@@ -53,16 +82,1239 @@ struct FilterParameter final
 {
     std::string name; /** @brief Name of the filter parameter. */
     double value; /** @brief Value of the parameter. */
+    std::string text = ""; /** @brief Text value of the parameter, for example a file name. */
+};
+
+/**
+ * @brief Number of neighbouring input samples that filter reads around every output sample.
+ */
+struct Halo final
+{
+    size_t before = 0; /** @brief Samples needed before the output sample. */
+    size_t after = 0; /** @brief Samples needed after the output sample. */
+};
+
+/**
+ * @brief Ratio of the output and input sample rates, up/down.
+ * Output sample m lies at the input position m*down/up.
+ */
+struct Rate final
+{
+    size_t up = 1; /** @brief Interpolation factor. */
+    size_t down = 1; /** @brief Decimation factor. */
+    
+    /**
+     * @brief Get number of output samples.
+     * @param length Number of input samples.
+     * @return Number of output samples, i.e. outputs whose position lies inside the input.
+     */
+    size_t outputLength(size_t length) const
+    {
+        return (length*up + down - 1)/down;
+    }
+};
+
+/**
+ * @brief Part of the signal processed by a single filter call.
+ * Filter writes output for < begin, end ) and may only read input from < first, last ).
+ * Input range always contains the full halo unless it is clipped by the ends of the signal,
+ * so the filter can tell the signal edges apart from the chunk edges.
+ */
+template<typename Sample>
+struct SignalWindow final
+{
+    const Sample* first; /** @brief First readable sample. */
+    const Sample* begin; /** @brief First sample to filter. */
+    const Sample* end; /** @brief End of the samples to filter. */
+    const Sample* last; /** @brief End of the readable samples. */
+};
+
+/**
+ * @brief Chunk of the signal assigned to a single task. Indices have the same meaning as in SignalWindow.
+ */
+struct SignalChunk final
+{
+    size_t first; /** @brief First readable sample. */
+    size_t begin; /** @brief First sample to filter. */
+    size_t end; /** @brief End of the samples to filter. */
+    size_t last; /** @brief End of the readable samples. */
+};
+
+/** @brief Default number of samples filtered by a single task. 256 KiB of doubles fits into L2 cache. */
+const size_t DEFAULT_TILE_SIZE = 32768;
+
+/** @brief Smallest transform used by overlap-save FIR convolution. */
+const size_t FIR_MIN_FFT_SIZE = 1024;
+
+/**
+ * @brief Range covering the whole signal.
+ * @param length Signal length.
+ * @return Range in which all samples are filtered and readable.
+ */
+inline SignalChunk wholeSignal(size_t length)
+{
+    return {0, 0, length, length};
+}
+
+std::vector<SignalChunk> partitionSignal(const SignalChunk& range, size_t chunkCount, const Halo& halo);
+std::vector<SignalChunk> tileSignal(const SignalChunk& range, size_t tileSize, size_t minTileCount, const Halo& halo);
+void forEachTile(ThreadPool& pool, const SignalChunk& range, size_t tileSize, const Halo& halo, const std::function<void(const SignalChunk&)>& task);
+void forEachChannelTile(ThreadPool& pool, size_t channels, const SignalChunk& range, size_t tileSize, const Halo& halo, const std::function<void(size_t, const SignalChunk&)>& task);
+
+/**
+ * @brief Detects recursive kernels, i.e. kernels that carry State from sample to sample.
+ */
+template<typename Kernel, typename = void>
+struct IsRecursive : std::false_type {};
+
+template<typename Kernel>
+struct IsRecursive<Kernel, std::void_t<typename Kernel::State>> : std::true_type {};
+
+/**
+ * @brief Detects recursive kernels that can also run several channels side by side.
+ */
+template<typename Kernel, typename = void>
+struct HasLanes : std::false_type {};
+
+template<typename Kernel>
+struct HasLanes<Kernel, std::void_t<decltype(Kernel::LANES)>> : std::true_type {};
+
+/**
+ * @brief Detects zero phase recursive kernels, i.e. kernels that run over the signal forward and then backward.
+ */
+template<typename Kernel, typename = void>
+struct HasBackwardPass : std::false_type {};
+
+template<typename Kernel>
+struct HasBackwardPass<Kernel, std::void_t<decltype(&Kernel::backwardState)>> : std::true_type {};
+
+/**
+ * @brief Detects resampling kernels, i.e. kernels whose output has a different sample rate.
+ */
+template<typename Kernel, typename = void>
+struct IsResampling : std::false_type {};
+
+template<typename Kernel>
+struct IsResampling<Kernel, std::void_t<decltype(&Kernel::rate)>> : std::true_type {};
+
+/**
+ * @brief Get ratio of the output and input sample rates of the filter.
+ * @param params Filter parameters.
+ * @return Rate of a resampling kernel, 1/1 for other kernels.
+ */
+template<typename Kernel>
+Rate filterRate(const typename Kernel::Parameters& params)
+{
+    if constexpr(IsResampling<Kernel>::value)
+        return Kernel::rate(params);
+    else
+        return Rate();
+}
+
+/**
+ * @brief Get number of output samples of the filter.
+ * @param length Number of input samples of a channel.
+ * @param params Filter parameters.
+ * @return Number of output samples of a channel.
+ */
+template<typename Kernel>
+size_t filteredLength(size_t length, const typename Kernel::Parameters& params)
+{
+    return filterRate<Kernel>(params).outputLength(length);
+}
+
+/**
+ * @brief Conversion of raw (integer) samples to physical values, value = raw*scale + offset.
+ */
+struct InputScale final
+{
+    double scale = 1; /** @brief Value of one raw unit. */
+    double offset = 0; /** @brief Value of raw zero. */
+};
+
+/**
+ * @brief Sample type in which signals stored as Raw are filtered and saved.
+ * Integer types map to the smallest floating point type that holds every raw value exactly.
+ */
+template<typename Raw>
+struct FilterSampleType
+{
+    typedef Raw type;
+};
+
+template<>
+struct FilterSampleType<int16_t>
+{
+    typedef float type;
+};
+
+template<>
+struct FilterSampleType<int32_t>
+{
+    typedef double type;
+};
+
+/**
+ * @brief Convert raw samples to the sample type of the filter.
+ * @param input Raw samples.
+ * @param count Number of samples.
+ * @param output Converted samples.
+ * @param scale Scale and offset.
+ */
+template<typename Raw, typename Sample>
+inline void convertSamples(const Raw* input, size_t count, Sample* output, const InputScale& scale)
+{
+    const Sample a = static_cast<Sample>(scale.scale);
+    const Sample b = static_cast<Sample>(scale.offset);
+    for(size_t i=0; i<count; i++)
+        output[i] = static_cast<Sample>(input[i])*a + b;
+}
+
+/**
+ * @brief Get contiguous input samples of a tile in the sample type of the filter.
+ * Contiguous samples of the same type are used in place, strided samples of an interleaved
+ * channel are gathered and raw samples are converted into the buffer.
+ * @param input First sample of the tile.
+ * @param count Number of samples.
+ * @param stride Distance between neighbouring samples.
+ * @param buffer Buffer for at least count samples.
+ * @param scale Scale and offset. Used only when Raw and Sample differ.
+ * @return Pointer to the samples.
+ */
+template<typename Raw, typename Sample>
+inline const Sample* loadSamples(const Raw* input, size_t count, size_t stride, Sample* buffer, const InputScale& scale)
+{
+    if constexpr(std::is_same<Raw, Sample>::value)
+    {
+        if(stride == 1)
+            return input;
+        for(size_t i=0; i<count; i++)
+            buffer[i] = input[i*stride];
+    }
+    else if(stride == 1)
+        convertSamples(input, count, buffer, scale);
+    else
+    {
+        const Sample a = static_cast<Sample>(scale.scale);
+        const Sample b = static_cast<Sample>(scale.offset);
+        for(size_t i=0; i<count; i++)
+            buffer[i] = static_cast<Sample>(input[i*stride])*a + b;
+    }
+    return buffer;
+}
+
+/**
+ * @brief Filter a single tile of one channel with a window kernel.
+ * Samples that can't be used in place are loaded, halo included, into a buffer owned by the worker,
+ * so conversion and gathering never make a separate pass over the signal.
+ * @param input First sample of the channel.
+ * @param stride Distance between neighbouring samples of the channel.
+ * @param tile Tile of the channel.
+ * @param output Output for the tile, output[0] corresponds to sample tile.begin.
+ * @param params Filter parameters.
+ * @param scale Conversion of raw input samples. Used only when Raw and Sample differ.
+ */
+template<typename Kernel, typename Raw, typename Sample>
+void filterTile(const Raw* input, size_t stride, const SignalChunk& tile, Sample* output, const typename Kernel::Parameters& params, const InputScale& scale)
+{
+    thread_local std::vector<Sample> buffer;
+    const size_t readable = tile.last-tile.first;
+    if(!std::is_same<Raw, Sample>::value || stride != 1)
+        buffer.resize(readable);
+    
+    const Sample* samples = loadSamples(input+tile.first*stride, readable, stride, buffer.data(), scale);
+    const SignalWindow<Sample> window = {samples, samples+(tile.begin-tile.first), samples+(tile.end-tile.first), samples+readable};
+    Kernel::filter(output, window, params);
+}
+
+/**
+ * @brief Compute a range of output samples of a resampling kernel.
+ * Only inputs of the range and the halo around them are loaded, so every output block is independent.
+ * @param input Readable input samples of the channel, input[0] is the sample at position inputFirst.
+ * @param stride Distance between neighbouring samples of the channel.
+ * @param inputFirst Position of input[0] in the signal. Either the start of the signal or
+ * at least the halo before the first input sample of the range.
+ * @param inputLast Position of the end of the readable input. Either the end of the signal or
+ * at least the halo after the last input sample of the range.
+ * @param firstOutput Index of the first output sample.
+ * @param count Number of output samples.
+ * @param output Output samples.
+ * @param params Filter parameters.
+ * @param scale Conversion of raw input samples. Used only when Raw and Sample differ.
+ */
+template<typename Kernel, typename Raw, typename Sample>
+void resampleTile(const Raw* input, size_t stride, size_t inputFirst, size_t inputLast, size_t firstOutput, size_t count, Sample* output, const typename Kernel::Parameters& params, const InputScale& scale)
+{
+    thread_local std::vector<Sample> buffer;
+    const Rate rate = Kernel::rate(params);
+    const Halo halo = Kernel::halo(params);
+    const size_t begin = firstOutput*rate.down/rate.up;
+    const size_t end = (firstOutput+count-1)*rate.down/rate.up + 1;
+    const size_t first = std::max(inputFirst, begin - std::min(begin, halo.before));
+    const size_t last = std::min(inputLast, end + halo.after);
+    const size_t readable = last-first;
+    if(!std::is_same<Raw, Sample>::value || stride != 1)
+        buffer.resize(readable);
+    
+    const Sample* samples = loadSamples(input+(first-inputFirst)*stride, readable, stride, buffer.data(), scale);
+    const SignalWindow<Sample> window = {samples, samples+(begin-first), samples+(end-first), samples+readable};
+    Kernel::filter(output, firstOutput, count, window, params);
+}
+
+/**
+ * @brief Aply recursive filter to every channel as a parallel linear recurrence scan.
+ * Pass 1 runs every tile from the zero state (the first one of the channel from the true state)
+ * and records its final state. Carries are then propagated serially from tile to tile (one step
+ * per tile), and pass 2 adds the response to the correct incoming state to every tile but the first.
+ * Tiles of all channels are scheduled together, so many short channels are filtered side by side.
+ * Raw or strided input is loaded tile by tile into the output, which the kernel then filters in place.
+ * Decimating kernels are tiled along the output, so every tile starts at a kept sample, and their
+ * input is loaded into a buffer owned by the worker.
+ * @param input Input samples.
+ * @param layout Arrangement of the input channels.
+ * @param output Output samples, one channel after another. Every channel holds filteredLength() samples.
+ * @param pool Thread pool on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples filtered by a single task.
+ * @param states State before the first sample of every channel. Replaced by the state after the last sample.
+ * @param scale Conversion of raw input samples. Used only when Raw and Sample differ.
+ */
+template<typename Kernel, typename Raw, typename Sample>
+void applyRecursive(const Raw* input, const SignalLayout& layout, Sample* output, ThreadPool& pool, const typename Kernel::Parameters& params, size_t tileSize, std::vector<typename Kernel::State>& states, const InputScale& scale = InputScale())
+{
+    typedef typename Kernel::State State;
+    const size_t down = filterRate<Kernel>(params).down;
+    const size_t length = filteredLength<Kernel>(layout.length, params);
+    const size_t minTileCount = (pool.size() + layout.channels - 1)/layout.channels;
+    const std::vector<SignalChunk> tiles = tileSignal(wholeSignal(length), std::max<size_t>(tileSize/down, 1), minTileCount, Halo());
+    const size_t tileCount = tiles.size();
+    
+    //number of input samples of the tile, the last one takes the samples after the last kept one too
+    const auto inputCount = [&layout, down](const SignalChunk& tile){ return std::min(tile.end*down, layout.length) - tile.begin*down; };
+    
+    //pass 1: local recurrences
+    std::vector<State> carries(layout.channels*tileCount, Kernel::zeroState(params));
+    pool.run(carries.size(), [&](size_t i)
+    {
+        thread_local std::vector<Sample> buffer;
+        const size_t channel = i/tileCount;
+        const SignalChunk& tile = tiles[i%tileCount];
+        const size_t count = inputCount(tile);
+        Sample* target = output + channel*length + tile.begin;
+        Sample* loaded = target;
+        if(down > 1)
+        {
+            buffer.resize(count);
+            loaded = buffer.data();
+        }
+        const Sample* samples = loadSamples(input + layout.channelOffset(channel) + tile.begin*down*layout.stride(), count, layout.stride(), loaded, scale);
+        carries[i] = Kernel::run(samples, count, target, i%tileCount == 0 ? states[channel] : carries[i], params);
+    });
+    if(tileCount == 1)
+    {
+        states = carries;
+        return;
+    }
+    
+    //carry propagation, carries[i] becomes the state before tile i
+    for(size_t channel=0; channel<layout.channels; channel++)
+    {
+        State state = states[channel];
+        for(size_t t=0; t<tileCount; t++)
+        {
+            State& carry = carries[channel*tileCount + t];
+            const State local = carry;
+            carry = state;
+            state = (t == 0) ? local : Kernel::carry(local, state, inputCount(tiles[t]), params);
+        }
+        states[channel] = state;
+    }
+    
+    //pass 2: add response to the incoming state
+    pool.run(layout.channels*(tileCount-1), [&](size_t i)
+    {
+        const size_t channel = i/(tileCount-1);
+        const size_t t = i%(tileCount-1) + 1;
+        const SignalChunk& tile = tiles[t];
+        Kernel::correct(output + channel*length + tile.begin, inputCount(tile), carries[channel*tileCount + t], params);
+    });
+}
+
+/**
+ * @brief Aply backward pass of a zero phase recursive filter to every channel in place.
+ * Same parallel scan as applyRecursive(), but tiles are visited from the last to the first,
+ * so carries propagate from the end of the channel towards its start.
+ * @param signal Output of the forward pass, one channel after another. Overwritten by the output.
+ * @param channels Number of channels.
+ * @param length Number of samples of every channel.
+ * @param pool Thread pool on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples filtered by a single task.
+ * @param states State after the last sample of every channel. Replaced by the state before the first sample.
+ */
+template<typename Kernel, typename Sample>
+void applyRecursiveBackward(Sample* signal, size_t channels, size_t length, ThreadPool& pool, const typename Kernel::Parameters& params, size_t tileSize, std::vector<typename Kernel::State>& states)
+{
+    typedef typename Kernel::State State;
+    const size_t minTileCount = (pool.size() + channels - 1)/channels;
+    const std::vector<SignalChunk> tiles = tileSignal(wholeSignal(length), tileSize, minTileCount, Halo());
+    const size_t tileCount = tiles.size();
+    const size_t lastTile = tileCount-1;
+    
+    //pass 1: local recurrences, the last tile of the channel starts from the true state
+    std::vector<State> carries(channels*tileCount, Kernel::zeroState(params));
+    pool.run(carries.size(), [&](size_t i)
+    {
+        const size_t channel = i/tileCount;
+        const SignalChunk& tile = tiles[i%tileCount];
+        Sample* target = signal + channel*length + tile.begin;
+        carries[i] = Kernel::runBackward(target, tile.end-tile.begin, target, i%tileCount == lastTile ? states[channel] : carries[i], params);
+    });
+    if(tileCount == 1)
+    {
+        states = carries;
+        return;
+    }
+    
+    //carry propagation from the end, carries[i] becomes the state after tile i
+    for(size_t channel=0; channel<channels; channel++)
+    {
+        State state = states[channel];
+        for(size_t t=tileCount; t-- > 0;)
+        {
+            State& carry = carries[channel*tileCount + t];
+            const State local = carry;
+            carry = state;
+            state = (t == lastTile) ? local : Kernel::carry(local, state, tiles[t].end-tiles[t].begin, params);
+        }
+        states[channel] = state;
+    }
+    
+    //pass 2: add response to the incoming state
+    pool.run(channels*(tileCount-1), [&](size_t i)
+    {
+        const size_t channel = i/(tileCount-1);
+        const size_t t = i%(tileCount-1);
+        const SignalChunk& tile = tiles[t];
+        Kernel::correctBackward(signal + channel*length + tile.begin, tile.end-tile.begin, carries[channel*tileCount + t], params);
+    });
+}
+
+/**
+ * @brief Aply recursive filter to groups of Kernel::LANES channels, every group in a single task.
+ * Channels of a group run side by side in vector lanes from start to end, so there is no
+ * carry propagation and no second pass.
+ * @param input Input samples.
+ * @param layout Arrangement of the input channels.
+ * @param output Output samples, one channel after another.
+ * @param pool Thread pool on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples of every channel passed to the kernel at once.
+ * @param states State before the first sample of every channel. Replaced by the state after the last sample.
+ * @param scale Conversion of raw input samples. Used only when Raw and Sample differ.
+ */
+template<typename Kernel, typename Raw, typename Sample>
+void applyRecursiveLanes(const Raw* input, const SignalLayout& layout, Sample* output, ThreadPool& pool, const typename Kernel::Parameters& params, size_t tileSize, std::vector<typename Kernel::State>& states, const InputScale& scale = InputScale())
+{
+    const size_t LANES = Kernel::LANES;
+    const size_t groupCount = (layout.channels + LANES - 1)/LANES;
+    
+    pool.run(groupCount, [&](size_t group)
+    {
+        const size_t firstChannel = group*LANES;
+        const size_t channelCount = std::min(LANES, layout.channels - firstChannel);
+        std::array<const Sample*, LANES> samples;
+        std::array<Sample*, LANES> targets;
+        for(size_t begin=0; begin<layout.length; begin+=tileSize)
+        {
+            const size_t count = std::min(tileSize, layout.length-begin);
+            for(size_t lane=0; lane<channelCount; lane++)
+            {
+                const size_t channel = firstChannel + lane;
+                targets[lane] = output + channel*layout.length + begin;
+                samples[lane] = loadSamples(input + layout.channelOffset(channel) + begin*layout.stride(), count, layout.stride(), targets[lane], scale);
+            }
+            Kernel::runLanes(samples.data(), count, targets.data(), channelCount, states.data()+firstChannel, params);
+        }
+    });
+}
+
+/**
+ * @brief Aply recursive filter to a single channel signal.
+ * @param input Input samples.
+ * @param length Number of samples.
+ * @param output Output samples.
+ * @param pool Thread pool on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples filtered by a single task.
+ * @param state State before the first sample.
+ * @param scale Conversion of raw input samples. Used only when Raw and Sample differ.
+ * @return State after the last sample.
+ */
+template<typename Kernel, typename Raw, typename Sample>
+typename Kernel::State applyRecursive(const Raw* input, size_t length, Sample* output, ThreadPool& pool, const typename Kernel::Parameters& params, size_t tileSize, typename Kernel::State state, const InputScale& scale = InputScale())
+{
+    std::vector<typename Kernel::State> states(1, state);
+    applyRecursive<Kernel>(input, SignalLayout{1, length, false}, output, pool, params, tileSize, states, scale);
+    return states[0];
+}
+
+/**
+ * @brief Aply window filter to part of a single channel signal using threads from the pool.
+ * Range is cut into tiles which are balanced between the threads by work stealing.
+ * Kernel is called directly, so the compiler sees its concrete type and parameters.
+ * @param input Input samples. They are only read, so they may come straight from a file mapping.
+ * @param range Samples to filter, < begin, end ), and samples the filter may read, < first, last ).
+ * Readable range must either contain the full halo or end where the signal ends.
+ * @param output Output samples. output[0] corresponds to input[range.begin].
+ * @param pool Thread pool on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples filtered by a single task.
+ * @param scale Conversion of raw input samples. Used only when Raw and Sample differ.
+ */
+template<typename Kernel, typename Raw, typename Sample>
+void applyFilter(const Raw* input, const SignalChunk& range, Sample* output, ThreadPool& pool, const typename Kernel::Parameters& params, size_t tileSize = DEFAULT_TILE_SIZE, const InputScale& scale = InputScale())
+{
+    if(range.begin == range.end)
+        return;
+    
+    forEachTile(pool, range, tileSize, Kernel::halo(params), [&](const SignalChunk& tile)
+    {
+        filterTile<Kernel>(input, 1, tile, output+(tile.begin-range.begin), params, scale);
+    });
+}
+
+/**
+ * @brief Aply filter to every channel of the signal using threads from the pool.
+ * Every channel is cut into tiles and all (channel, tile) pairs are balanced between the threads
+ * together, so short channels are spread across threads instead of being split along time.
+ * Resampling kernels are tiled along the output, so only the kept output samples are computed.
+ * @param input Input samples. They are only read, so they may come straight from a file mapping.
+ * @param layout Arrangement of the input channels.
+ * @param output Output samples, one channel after another (C order). Every channel holds filteredLength() samples.
+ * @param pool Thread pool on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples filtered by a single task.
+ * @param scale Conversion of raw input samples. Used only when Raw and Sample differ.
+ */
+template<typename Kernel, typename Raw, typename Sample>
+void applyFilter(const Raw* input, const SignalLayout& layout, Sample* output, ThreadPool& pool, const typename Kernel::Parameters& params, size_t tileSize = DEFAULT_TILE_SIZE, const InputScale& scale = InputScale())
+{
+    if(layout.size() == 0)
+        return;
+    
+    if constexpr(IsRecursive<Kernel>::value)
+    {
+        //every channel starts from its own first sample, backward pass from its last one
+        std::vector<typename Kernel::State> states(layout.channels);
+        std::vector<double> lastSamples(HasBackwardPass<Kernel>::value ? layout.channels : 0);
+        for(size_t channel=0; channel<layout.channels; channel++)
+        {
+            Sample first;
+            states[channel] = Kernel::initialState(loadSamples(input + layout.channelOffset(channel), 1, 1, &first, scale), params);
+            if constexpr(HasBackwardPass<Kernel>::value)
+            {
+                Sample last;
+                lastSamples[channel] = *loadSamples(input + layout.channelOffset(channel) + (layout.length-1)*layout.stride(), 1, 1, &last, scale);
+            }
+        }
+        
+        //with a group of channels for every thread lanes beat splitting channels along time
+        if constexpr(HasLanes<Kernel>::value)
+        {
+            if(layout.channels > 1 && (layout.channels + Kernel::LANES - 1)/Kernel::LANES >= pool.size())
+            {
+                applyRecursiveLanes<Kernel>(input, layout, output, pool, params, tileSize, states, scale);
+                return;
+            }
+        }
+        applyRecursive<Kernel>(input, layout, output, pool, params, tileSize, states, scale);
+        
+        if constexpr(HasBackwardPass<Kernel>::value)
+        {
+            for(size_t channel=0; channel<layout.channels; channel++)
+                states[channel] = Kernel::backwardState(states[channel], lastSamples[channel], params);
+            applyRecursiveBackward<Kernel>(output, layout.channels, layout.length, pool, params, tileSize, states);
+        }
+    }
+    else if constexpr(IsResampling<Kernel>::value)
+    {
+        const size_t length = filteredLength<Kernel>(layout.length, params);
+        forEachChannelTile(pool, layout.channels, wholeSignal(length), tileSize, Halo(), [&](size_t channel, const SignalChunk& tile)
+        {
+            resampleTile<Kernel>(input + layout.channelOffset(channel), layout.stride(), 0, layout.length, tile.begin, tile.end-tile.begin, output + channel*length + tile.begin, params, scale);
+        });
+    }
+    else
+    {
+        forEachChannelTile(pool, layout.channels, wholeSignal(layout.length), tileSize, Kernel::halo(params), [&](size_t channel, const SignalChunk& tile)
+        {
+            filterTile<Kernel>(input + layout.channelOffset(channel), layout.stride(), tile, output + channel*layout.length + tile.begin, params, scale);
+        });
+    }
+}
+
+/**
+ * @brief Aply filter to a single channel signal using threads from the pool.
+ * @param input Input samples. They are only read, so they may come straight from a file mapping.
+ * @param length Number of samples.
+ * @param output Output samples.
+ * @param pool Thread pool on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples filtered by a single task.
+ * @param scale Conversion of raw input samples. Used only when Raw and Sample differ.
+ */
+template<typename Kernel, typename Raw, typename Sample>
+void applyFilter(const Raw* input, size_t length, Sample* output, ThreadPool& pool, const typename Kernel::Parameters& params, size_t tileSize = DEFAULT_TILE_SIZE, const InputScale& scale = InputScale())
+{
+    applyFilter<Kernel>(input, SignalLayout{1, length, false}, output, pool, params, tileSize, scale);
+}
+
+/** @brief Source of streamed samples. Fills the buffer with up to count samples, returns 0 at the end of the stream. */
+template<typename Sample>
+using SampleSource = std::function<size_t(Sample*, size_t)>;
+
+/** @brief Sink of streamed samples. */
+template<typename Sample>
+using SampleSink = std::function<void(const Sample*, size_t)>;
+
+/**
+ * @brief Read from the source until the buffer is full or the stream ends.
+ * @param source Sample source.
+ * @param buffer Output buffer.
+ * @param count Number of samples to read.
+ * @return Number of samples read. Less than count only at the end of the stream.
+ */
+template<typename Sample>
+size_t readFull(const SampleSource<Sample>& source, Sample* buffer, size_t count)
+{
+    size_t total = 0;
+    while(total < count)
+    {
+        const size_t read = source(buffer+total, count-total);
+        if(read == 0)
+            break;
+        total += read;
+    }
+    return total;
+}
+
+/**
+ * @brief Stream the signal through the filter in chunks, using memory bounded by memoryBudget.
+ * Window filters keep halo.before samples of history and halo.after samples of look-ahead
+ * between the chunks, recursive filters carry their state, so the output is identical to
+ * filtering the whole signal at once. Resampling filters pass to the sink the output samples
+ * lying inside the samples read so far. Every chunk is filtered in parallel on the pool.
+ * @param source Sample source.
+ * @param sink Sample sink.
+ * @param pool Thread pool on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples filtered by a single task.
+ * @param memoryBudget Size of the sample buffers in bytes.
+ * @param blockSize Maximum number of samples read from the source before the sink is fed,
+ * 0 to use the whole budget. Small blocks lower latency at the cost of throughput.
+ * @return Number of filtered (input) samples.
+ * @throw InvalidParameter If the budget can't hold the filter's halo.
+ */
+template<typename Kernel, typename Sample>
+size_t streamFilter(const SampleSource<Sample>& source, const SampleSink<Sample>& sink, ThreadPool& pool, const typename Kernel::Parameters& params, size_t tileSize, size_t memoryBudget, size_t blockSize = 0)
+{
+    const size_t budget = memoryBudget/sizeof(Sample);
+    size_t total = 0;
+    
+    if constexpr(IsRecursive<Kernel>::value)
+    {
+        static_assert(!HasBackwardPass<Kernel>::value, "Backward pass needs the end of the signal, zero phase filters can't be streamed.");
+        
+        //input and output chunk, every chunk starts at a kept sample
+        const size_t down = filterRate<Kernel>(params).down;
+        const size_t maxChunkSize = budget/2 - (budget/2)%down;
+        const size_t chunkSize = blockSize ? std::min(maxChunkSize, (blockSize + down - 1)/down*down) : maxChunkSize;
+        if(chunkSize == 0)
+            throw(InvalidParameter("Memory budget is too small!"));
+        
+        std::vector<Sample> input(chunkSize);
+        std::vector<Sample> output(filteredLength<Kernel>(chunkSize, params));
+        typename Kernel::State state = Kernel::zeroState(params);
+        while(const size_t count = readFull(source, input.data(), chunkSize))
+        {
+            if(total == 0)
+                state = Kernel::initialState(input.data(), params);
+            state = applyRecursive<Kernel>(input.data(), count, output.data(), pool, params, tileSize, state);
+            sink(output.data(), filteredLength<Kernel>(count, params));
+            total += count;
+        }
+    }
+    else if constexpr(IsResampling<Kernel>::value)
+    {
+        //input holds the history of the next output sample + its look-ahead + chunk,
+        //output holds the output samples that become ready after the chunk
+        const Rate rate = Kernel::rate(params);
+        const Halo halo = Kernel::halo(params);
+        const size_t reserved = halo.before + halo.after + rate.outputLength(halo.after) + 1;
+        const size_t maxChunkSize = budget > reserved ? (budget - reserved)*rate.down/(rate.up + rate.down) : 0;
+        const size_t chunkSize = blockSize ? std::min(maxChunkSize, blockSize) : maxChunkSize;
+        if(chunkSize == 0)
+            throw(InvalidParameter("Memory budget is too small for the filter halo!"));
+        
+        std::vector<Sample> input(halo.before + halo.after + chunkSize);
+        std::vector<Sample> output(rate.outputLength(halo.after + chunkSize));
+        size_t inputFirst = 0; //position of input[0] in the signal
+        size_t written = 0; //output samples passed to the sink
+        bool finished = false;
+        while(!finished)
+        {
+            const size_t count = readFull(source, input.data()+(total-inputFirst), chunkSize);
+            finished = count < chunkSize;
+            total += count;
+            
+            //output samples with the whole look-ahead available
+            const size_t ready = rate.outputLength(finished ? total : total - std::min(total, halo.after));
+            if(ready > written)
+            {
+                forEachTile(pool, SignalChunk{written, written, ready, ready}, tileSize, Halo(), [&](const SignalChunk& tile)
+                {
+                    resampleTile<Kernel>(input.data(), 1, inputFirst, total, tile.begin, tile.end-tile.begin, output.data()+(tile.begin-written), params, InputScale());
+                });
+                sink(output.data(), ready-written);
+                written = ready;
+            }
+            
+            //move history and look-ahead of the next output sample to the front
+            const size_t next = std::min(total, written*rate.down/rate.up);
+            const size_t kept = std::max(inputFirst, next - std::min(next, halo.before));
+            std::copy(input.begin()+(kept-inputFirst), input.begin()+(total-inputFirst), input.begin());
+            inputFirst = kept;
+        }
+    }
+    else
+    {
+        //input holds history + chunk + look-ahead, output holds chunk + look-ahead
+        const Halo halo = Kernel::halo(params);
+        if(budget <= halo.before + 2*halo.after + 1)
+            throw(InvalidParameter("Memory budget is too small for the filter halo!"));
+        const size_t maxChunkSize = (budget - halo.before - 2*halo.after)/2;
+        const size_t chunkSize = blockSize ? std::min(maxChunkSize, blockSize) : maxChunkSize;
+        
+        std::vector<Sample> input(halo.before + chunkSize + halo.after);
+        std::vector<Sample> output(chunkSize + halo.after);
+        size_t history = 0; //samples kept in front of the next output sample
+        size_t pending = 0; //samples from the next output sample on
+        bool finished = false;
+        while(!finished)
+        {
+            const size_t requested = output.size() - pending;
+            const size_t count = readFull(source, input.data()+history+pending, requested);
+            finished = count < requested;
+            pending += count;
+            
+            //samples with the whole look-ahead available
+            const size_t ready = finished ? pending : pending - std::min(pending, halo.after);
+            const SignalChunk range = {0, history, history+ready, history+pending};
+            applyFilter<Kernel>(input.data(), range, output.data(), pool, params, tileSize);
+            sink(output.data(), ready);
+            total += ready;
+            
+            //move history and look-ahead to the front
+            const size_t next = history + ready;
+            const size_t kept = std::min(next, halo.before);
+            std::copy(input.begin()+(next-kept), input.begin()+(history+pending), input.begin());
+            history = kept;
+            pending -= ready;
+        }
+    }
+    
+    return total;
+}
+
+/**
+ * @brief Aply filter to the signal using threads from the pool.
+ * @param signal Input signal. 
+ * @param pool Thread pool on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples filtered by a single task.
+ * @return Vector containing filtered signal.
+ */
+template<typename Kernel, typename Sample>
+std::vector<Sample> applyFilter(const std::vector<Sample>& signal, ThreadPool& pool, const typename Kernel::Parameters& params, size_t tileSize = DEFAULT_TILE_SIZE)
+{
+    std::vector<Sample> output(filteredLength<Kernel>(signal.size(), params));
+    applyFilter<Kernel>(signal.data(), signal.size(), output.data(), pool, params, tileSize);
+    return output;
+}
+
+/**
+ * @brief Aply filter to the signal using the default thread pool.
+ * @param signal Input signal. 
+ * @param threadCount Number of threads on which the filter will run.
+ * @param params Filter parameters.
+ * @param tileSize Number of samples filtered by a single task.
+ * @return Vector containing filtered signal.
+ */
+template<typename Kernel, typename Sample>
+std::vector<Sample> applyFilter(const std::vector<Sample>& signal, unsigned int threadCount, const typename Kernel::Parameters& params, size_t tileSize = DEFAULT_TILE_SIZE)
+{
+    return applyFilter<Kernel>(signal, defaultThreadPool(threadCount), params, tileSize);
+}
+
+/**
+ * @brief Parameters of the moving average filter.
+ */
+struct MovingAverageParameters final
+{
+    size_t blockSize; /** @brief Number of averaged samples. */
+    size_t decimation = 1; /** @brief Only every decimation-th output sample is computed and kept. */
+};
+
+/**
+ * @brief Parameters of the exponential filter.
+ */
+struct ExponentialParameters final
+{
+    double dampingCoeff; /** @brief Weight of the newest sample. */
+    size_t decimation = 1; /** @brief Only every decimation-th output sample is kept. */
+};
+
+/**
+ * @brief Parameters of the median filter.
+ */
+struct MedianParameters final
+{
+    size_t blockSize; /** @brief Window size. */
+    size_t decimation = 1; /** @brief Only every decimation-th output sample is computed and kept. */
+};
+
+/**
+ * @brief Parameters of the FIR filter.
+ */
+struct FirParameters final
+{
+    std::vector<double> taps; /** @brief Filter coefficients, taps[0] weights the newest sample. */
+    std::shared_ptr<const Fft> fft; /** @brief Transform used by overlap-save convolution. Empty for direct convolution. */
+    bool fftForced; /** @brief Overlap-save convolution was asked for, otherwise it is used only from the crossover of the selected kernels on. */
+    std::vector<double> spectrumReal; /** @brief Real part of the transform of the zero padded coefficients. */
+    std::vector<double> spectrumImag; /** @brief Imaginary part of the transform of the zero padded coefficients. */
+};
+
+/**
+ * @brief Coefficients of the Savitzky-Golay filter, shared by every filter with the same window and orders.
+ */
+struct SavitzkyGolayCoefficients final
+{
+    FirParameters centre; /** @brief Weights of the centred window as FIR taps, taps[j] weights sample i+window/2-j of output i. */
+    std::vector<double> fits; /** @brief Weights of a whole window for the fit at every position in it, window x window, row major. Used at the signal edges. */
+};
+
+/**
+ * @brief Parameters of the Savitzky-Golay filter.
+ */
+struct SavitzkyGolayParameters final
+{
+    size_t window; /** @brief Number of fitted samples, odd. */
+    size_t polyOrder; /** @brief Order of the fitted polynomial. */
+    size_t derivOrder; /** @brief Order of the derivative of the fit, per sample. 0 for smoothing. */
+    std::shared_ptr<const SavitzkyGolayCoefficients> coefficients; /** @brief Coefficients, computed once per window and orders. */
+};
+
+/**
+ * @brief Parameters of the biquad cascade filter.
+ */
+struct BiquadParameters final
+{
+    size_t sections; /** @brief Number of second order sections. */
+    std::vector<double> coefficients; /** @brief b0, b1, b2, a1, a2 of every section, normalised by a0. */
+    std::vector<double> transition; /** @brief Matrix advancing the state of the whole cascade by one sample of zero input, row major. */
+};
+
+/**
+ * @brief Parameters of the recursive Gaussian filter.
+ */
+struct GaussianParameters final
+{
+    double sigma; /** @brief Standard deviation of the Gaussian [samples]. */
+    double gain; /** @brief Weight of the input sample, sets the gain at DC to 1. */
+    std::array<double, 3> feedback; /** @brief Weights of the last three outputs of the pass. */
+    std::array<std::complex<double>, 3> poles; /** @brief Poles of the recurrence, the real one first. */
+    std::array<std::complex<double>, 9> modes; /** @brief Matrix splitting the state into the weights of the decaying modes, 3 x 3, row major. */
+    std::array<double, 9> boundary; /** @brief Matrix mapping the deviation of the final forward state from the last sample to the initial backward state, 3 x 3, row major. */
+};
+
+/**
+ * @brief Parameters of the polyphase resampling filter.
+ */
+struct ResamplerParameters final
+{
+    Rate rate; /** @brief Output to input sample rate ratio, reduced to lowest terms. */
+    std::vector<double> taps; /** @brief Filter coefficients at the upsampled rate, taps[0] weights the newest sample. */
+    size_t phaseLength; /** @brief Number of coefficients of every phase, ceil(taps.size()/rate.up). */
+    std::vector<double> phases; /** @brief Coefficients of every phase, taps[phase + j*up] stored at phases[phase*phaseLength + phaseLength-1-j]. */
+};
+
+/*
+ * Filter kernels. Every kernel provides:
+ *  - Parameters: typed parameter structure,
+ *  - parse(): conversion from the named parameter list (done once, before filtering),
+ *  - halo(): number of neighbouring samples read around every output sample,
+ *  - filter(): computation of the output for a single SignalWindow.
+ *
+ * Recursive kernels (linear recurrences) provide State instead of halo() and filter():
+ *  - initialState(): state before the first sample of the signal,
+ *  - zeroState(): state of the system at rest,
+ *  - run(): recurrence over a range of samples, returns the final state (must work in place),
+ *  - carry(): final state of a range given its final state from rest and the state before the range,
+ *  - correct(): add response to the state before the range to output computed from rest.
+ * They may also provide LANES and runLanes(), recurrence over up to LANES channels at once.
+ * Zero phase kernels run a second recurrence from the end of the signal to its start and provide:
+ *  - backwardState(): state before the backward pass given the final forward state and the last sample,
+ *  - runBackward(), correctBackward(): run() and correct() going from the end of the range to its start.
+ * The same carry() serves both passes.
+ *
+ * Resampling kernels additionally provide rate(). Their halo() is counted in input samples and
+ * their filter() receives the index of the first output sample, as the window only covers the inputs.
+ * Recursive kernels may provide rate() too, with up = 1. Their run() and correct() then get ranges
+ * starting at a kept sample and write only the kept outputs, one every rate.down input samples.
+ */
+
+/**
+ * @brief Moving average filter. Output sample is the average of the last blockSize
+ * input samples. First blockSize-1 samples of the signal are copied.
+ * With decimation only every decimation-th output sample is computed.
+ */
+struct MovingAverage final
+{
+    typedef MovingAverageParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Rate rate(const Parameters& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, size_t firstOutput, size_t count, const SignalWindow<Sample>& window, const Parameters& params);
+};
+
+/**
+ * @brief Reference moving average filter. Sums the whole window for every output sample.
+ */
+struct MovingAverageReference final
+{
+    typedef MovingAverageParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Rate rate(const Parameters& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, size_t firstOutput, size_t count, const SignalWindow<Sample>& window, const Parameters& params);
+};
+
+/**
+ * @brief Exponential filter, y[n] = a*x[n] + (1-a)*y[n-1]. Filter starts from y[-1] = x[0].
+ * With decimation the recurrence still runs over every sample, but only every decimation-th
+ * output sample is stored and corrected.
+ */
+struct Exponential final
+{
+    typedef ExponentialParameters Parameters;
+    typedef double State; /** @brief Previous output sample. Kept in double precision for every sample type. */
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Rate rate(const Parameters& params);
+    template<typename Sample>
+    static State initialState(const Sample* signal, const Parameters& params);
+    static State zeroState(const Parameters& params);
+    template<typename Sample>
+    static State run(const Sample* input, size_t count, Sample* output, State state, const Parameters& params);
+    static State carry(State local, State incoming, size_t count, const Parameters& params);
+    template<typename Sample>
+    static void correct(Sample* output, size_t count, State incoming, const Parameters& params);
+};
+
+/**
+ * @brief Median filter. Output sample is the median of the next blockSize
+ * input samples. Last blockSize-1 samples of the signal are copied.
+ * With decimation only every decimation-th output sample is computed.
+ */
+struct Median final
+{
+    typedef MedianParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Rate rate(const Parameters& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, size_t firstOutput, size_t count, const SignalWindow<Sample>& window, const Parameters& params);
+};
+
+/**
+ * @brief Reference median filter. Sorts the whole window for every output sample.
+ */
+struct MedianReference final
+{
+    typedef MedianParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Rate rate(const Parameters& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, size_t firstOutput, size_t count, const SignalWindow<Sample>& window, const Parameters& params);
+};
+
+/**
+ * @brief Finite impulse response filter. Output sample is the sum of the last taps.size()
+ * input samples weighted by the coefficients. Samples before the start of the signal are zero.
+ * Short filters are convolved directly, with sums accumulated in the sample type. Long ones
+ * use overlap-save FFT convolution in double precision.
+ */
+struct Fir final
+{
+    typedef FirParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, const SignalWindow<Sample>& window, const Parameters& params);
+};
+
+/**
+ * @brief Reference FIR filter. Accumulates every output sample in double precision.
+ */
+struct FirReference final
+{
+    typedef FirParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, const SignalWindow<Sample>& window, const Parameters& params);
+};
+
+/**
+ * @brief Savitzky-Golay filter. Output sample is the value (or derivative) at its position of the polynomial
+ * least squares fitted to the window centred on it. Fits are linear in the samples, so the filter is a centred
+ * FIR filter, run by the FIR kernel. First and last window/2 outputs come from the fit to the first and last
+ * window of the signal. Signals shorter than the window are fitted as a whole.
+ */
+struct SavitzkyGolay final
+{
+    typedef SavitzkyGolayParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, const SignalWindow<Sample>& window, const Parameters& params);
+};
+
+/**
+ * @brief Reference Savitzky-Golay filter. Weights every window in double precision.
+ */
+struct SavitzkyGolayReference final
+{
+    typedef SavitzkyGolayParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, const SignalWindow<Sample>& window, const Parameters& params);
+};
+
+/**
+ * @brief Cascade of second order IIR sections (biquads), e.g. Butterworth or Chebyshev filters
+ * designed as second order sections. Sections are in transposed direct form II and computed in
+ * double precision. Filter starts in the steady state for the first sample, as if it had seen it forever.
+ */
+struct BiquadCascade final
+{
+    typedef BiquadParameters Parameters;
+    typedef std::vector<double> State; /** @brief s1 and s2 of every section. */
+    static constexpr size_t LANES = BIQUAD_LANES;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    template<typename Sample>
+    static State initialState(const Sample* signal, const Parameters& params);
+    static State zeroState(const Parameters& params);
+    template<typename Sample>
+    static State run(const Sample* input, size_t count, Sample* output, State state, const Parameters& params);
+    static State carry(State local, State incoming, size_t count, const Parameters& params);
+    template<typename Sample>
+    static void correct(Sample* output, size_t count, State incoming, const Parameters& params);
+    template<typename Sample>
+    static void runLanes(const Sample* const* inputs, size_t count, Sample* const* outputs, size_t channelCount, State* states, const Parameters& params);
+};
+
+/**
+ * @brief Gaussian smoothing filter built from a third order recursive filter (Young and van Vliet)
+ * run forward and then backward, so the output has zero phase and every sample costs the same
+ * whatever the sigma. Forward pass starts as if the first sample had been seen forever, backward
+ * pass as if the last sample went on forever (Triggs and Sdika boundary). Computed in double precision.
+ * Sigma is fitted to the shape of the Gaussian, tails of the recursive filter are a bit heavier.
+ */
+struct Gaussian final
+{
+    typedef GaussianParameters Parameters;
+    typedef std::array<double, 3> State; /** @brief Last three outputs of the pass, the newest first. */
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    template<typename Sample>
+    static State initialState(const Sample* signal, const Parameters& params);
+    static State zeroState(const Parameters& params);
+    static State backwardState(State forward, double last, const Parameters& params);
+    template<typename Sample>
+    static State run(const Sample* input, size_t count, Sample* output, State state, const Parameters& params);
+    template<typename Sample>
+    static State runBackward(const Sample* input, size_t count, Sample* output, State state, const Parameters& params);
+    static State carry(State local, State incoming, size_t count, const Parameters& params);
+    template<typename Sample>
+    static void correct(Sample* output, size_t count, State incoming, const Parameters& params);
+    template<typename Sample>
+    static void correctBackward(Sample* output, size_t count, State incoming, const Parameters& params);
+};
+
+/**
+ * @brief Polyphase resampling filter. Signal is upsampled by rate.up (zeros inserted between the samples),
+ * filtered by the FIR filter and decimated by rate.down. Only the kept output samples are computed and only
+ * the non zero inputs are multiplied, so every output costs ceil(taps/up) multiplications.
+ * Samples before the start of the signal are zero, sums are accumulated in the sample type.
+ * Interpolating filters need the gain of up to keep the signal level.
+ */
+struct Resampler final
+{
+    typedef ResamplerParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Rate rate(const Parameters& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, size_t firstOutput, size_t count, const SignalWindow<Sample>& window, const Parameters& params);
+};
+
+/**
+ * @brief Reference resampling filter. Upsamples with explicit zeros, filters and decimates
+ * every output sample in double precision.
+ */
+struct ResamplerReference final
+{
+    typedef ResamplerParameters Parameters;
+    static Parameters parse(const std::vector<FilterParameter>& params);
+    static Rate rate(const Parameters& params);
+    static Halo halo(const Parameters& params);
+    template<typename Sample>
+    static void filter(Sample* target, size_t firstOutput, size_t count, const SignalWindow<Sample>& window, const Parameters& params);
 };
 
-/** @brief Filter function. */
-typedef std::function<void(std::vector<double>::iterator, std::vector<double>::iterator, std::vector<double>::iterator, std::vector<FilterParameter>)> Filter;
+/** @brief Filter with parameters already bound to a single sample type. Receives input, its layout, output, thread pool and tile size. */
+template<typename Sample>
+using TypedFilterRunner = std::function<void(const Sample*, const SignalLayout&, Sample*, ThreadPool&, size_t)>;
 
-std::vector<double> applyFilter(std::vector<double>& signal, unsigned int threadCount, Filter filter, const std::vector<FilterParameter>& params);
+/** @brief Streaming filter with parameters already bound to a single sample type. Receives source, sink, thread pool, tile size, memory budget and block size. Returns number of samples. */
+template<typename Sample>
+using TypedStreamRunner = std::function<size_t(const SampleSource<Sample>&, const SampleSink<Sample>&, ThreadPool&, size_t, size_t, size_t)>;
+
+/** @brief Filter with parameters already bound, converting Raw input to Sample. Receives input, its layout, output, input scale, thread pool and tile size. */
+template<typename Raw, typename Sample>
+using ScaledFilterRunner = std::function<void(const Raw*, const SignalLayout&, Sample*, const InputScale&, ThreadPool&, size_t)>;
+
+/**
+ * @brief Filter with parameters already bound, instantiated for every supported sample type.
+ * Call operator picks the instantiation matching the signal. Integer input is filtered
+ * as float32 (int16) or float64 (int32), both hold every raw value exactly.
+ */
+struct FilterRunner final
+{
+    TypedFilterRunner<double> float64; /** @brief Double precision filter. */
+    TypedFilterRunner<float> float32; /** @brief Single precision filter. */
+    ScaledFilterRunner<int16_t, float> int16; /** @brief Single precision filter of int16 input. */
+    ScaledFilterRunner<int32_t, double> int32; /** @brief Double precision filter of int32 input. */
+    Rate rate; /** @brief Output to input sample rate ratio. */
+    
+    void operator()(const double* input, const SignalLayout& layout, double* output, ThreadPool& pool, size_t tileSize) const
+    {
+        float64(input, layout, output, pool, tileSize);
+    }
+    
+    void operator()(const float* input, const SignalLayout& layout, float* output, ThreadPool& pool, size_t tileSize) const
+    {
+        float32(input, layout, output, pool, tileSize);
+    }
+    
+    void operator()(const int16_t* input, const SignalLayout& layout, float* output, const InputScale& scale, ThreadPool& pool, size_t tileSize) const
+    {
+        int16(input, layout, output, scale, pool, tileSize);
+    }
+    
+    void operator()(const int32_t* input, const SignalLayout& layout, double* output, const InputScale& scale, ThreadPool& pool, size_t tileSize) const
+    {
+        int32(input, layout, output, scale, pool, tileSize);
+    }
+    
+    /**
+     * @brief Run filter on input of any supported type. Scale is used only for integer input.
+     * @param input Input samples.
+     * @param layout Arrangement of the input channels.
+     * @param output Output samples.
+     * @param scale Conversion of raw input samples.
+     * @param pool Thread pool on which the filter will run.
+     * @param tileSize Number of samples filtered by a single task.
+     */
+    template<typename Raw, typename Sample>
+    void run(const Raw* input, const SignalLayout& layout, Sample* output, const InputScale& scale, ThreadPool& pool, size_t tileSize) const
+    {
+        if constexpr(std::is_same<Raw, Sample>::value)
+            (*this)(input, layout, output, pool, tileSize);
+        else
+            (*this)(input, layout, output, scale, pool, tileSize);
+    }
+    
+    /**
+     * @brief Get number of output samples of every channel.
+     * @param length Number of input samples of every channel.
+     * @return Number of output samples of every channel.
+     */
+    size_t outputLength(size_t length) const
+    {
+        return rate.outputLength(length);
+    }
+    
+    /**
+     * @brief Get shape of the output array.
+     * @param shape Shape of the input array, samples are the last dimension.
+     * @return Shape of the output array.
+     */
+    std::vector<size_t> outputShape(std::vector<size_t> shape) const
+    {
+        if(!shape.empty())
+            shape.back() = outputLength(shape.back());
+        return shape;
+    }
+    
+    explicit operator bool() const
+    {
+        return static_cast<bool>(float64);
+    }
+};
+
+/**
+ * @brief Streaming filter with parameters already bound, instantiated for every supported sample type.
+ */
+struct StreamRunner final
+{
+    TypedStreamRunner<double> float64; /** @brief Double precision filter. */
+    TypedStreamRunner<float> float32; /** @brief Single precision filter. */
+    
+    size_t operator()(const SampleSource<double>& source, const SampleSink<double>& sink, ThreadPool& pool, size_t tileSize, size_t memoryBudget, size_t blockSize = 0) const
+    {
+        return float64(source, sink, pool, tileSize, memoryBudget, blockSize);
+    }
+    
+    size_t operator()(const SampleSource<float>& source, const SampleSink<float>& sink, ThreadPool& pool, size_t tileSize, size_t memoryBudget, size_t blockSize = 0) const
+    {
+        return float32(source, sink, pool, tileSize, memoryBudget, blockSize);
+    }
+    
+    explicit operator bool() const
+    {
+        return static_cast<bool>(float64);
+    }
+};
+
+/**
+ * @brief Filter that can be selected by name.
+ */
+struct FilterInfo final
+{
+    std::string name; /** @brief Name used on the command line. */
+    std::string description; /** @brief Human readable name. */
+    std::function<FilterRunner(const std::vector<FilterParameter>&)> create; /** @brief Parse parameters and bind them to the kernel. */
+    std::function<FilterRunner(const std::vector<FilterParameter>&)> createReference; /** @brief Same for the reference kernel. Empty if there is none. */
+    std::function<StreamRunner(const std::vector<FilterParameter>&)> createStream; /** @brief Parse parameters and bind them to the streaming driver. Empty if the filter can't be streamed. */
+};
 
-//filters
-void movingAverage_filter(std::vector<double>::iterator target, std::vector<double>::iterator rangeStart, std::vector<double>::iterator rangeEnd, const std::vector<FilterParameter>& params);
-void exponential_filter(std::vector<double>::iterator target, std::vector<double>::iterator rangeStart, std::vector<double>::iterator rangeEnd, const std::vector<FilterParameter>& params);
-void median_filter(std::vector<double>::iterator target, std::vector<double>::iterator rangeStart, std::vector<double>::iterator rangeEnd, const std::vector<FilterParameter>& params);
+const std::vector<FilterInfo>& filterRegistry();
+const FilterInfo* findFilter(const std::string& name);
 
 #endif
@@ -0,0 +1,59 @@
+/**
+ * @file medianetwork.cpp
+ * @brief This source file contains code for the sorting network median of small windows.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  
+
+#include "medianetwork.hpp"
+#include "simd.hpp"
+
+/**
+ * @brief Check if there is sorting network for given window size.
+ * @param blockSize Window size.
+ * @return True if the size is supported by medianNetwork_filter.
+ */
+bool isMedianNetworkSize(size_t blockSize)
+{
+    switch(blockSize)
+    {
+        case 3: case 5: case 7: case 9: case 15: case 25:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Median of small windows computed by a sorting network,
+ * vectorised for the instruction set picked at run time.
+ * output[i] is the median of input[i*stride] ... input[i*stride+blockSize-1].
+ * @param blockSize Window size. Must be accepted by isMedianNetworkSize.
+ * @param input First sample of the first window.
+ * @param count Number of windows.
+ * @param output Output for the medians.
+ * @param stride Distance between the first samples of neighbouring windows.
+ */
+template<typename Sample>
+void medianNetwork_filter(size_t blockSize, const Sample* input, size_t count, Sample* output, size_t stride)
+{
+    simdKernels<Sample>().medianNetwork(blockSize, input, count, stride, output);
+}
+
+template void medianNetwork_filter<double>(size_t, const double*, size_t, double*, size_t);
+template void medianNetwork_filter<float>(size_t, const float*, size_t, float*, size_t);
@@ -0,0 +1,111 @@
+/**
+ * @file polyfit.cpp
+ * @brief This source file contains least squares polynomial fitting.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#include "polyfit.hpp"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Weights of the least squares polynomial fit.
+ * Fit is linear in the samples, so its value (or derivative) at every sample is a weighted sum
+ * of all of them. Positions are scaled to < -1, 1 > and the columns of the Vandermonde matrix are
+ * orthonormalised (modified Gram-Schmidt, A = QR), so the fit stays accurate for high orders,
+ * where the normal equations would not. Coefficients of the fit are then R^-1 Q^T samples.
+ * @param length Number of samples.
+ * @param polyOrder Order of the polynomial. Must be smaller than length.
+ * @param derivOrder Order of the derivative, per sample. 0 for the value of the fit.
+ * @return length x length row major matrix, row t holds the weights giving the fit at sample t.
+ */
+std::vector<double> polynomialFitWeights(size_t length, size_t polyOrder, size_t derivOrder)
+{
+    const size_t terms = polyOrder+1;
+    const double centre = (length-1)/2.0;
+    const double scale = std::max(centre, 1.0);
+    
+    //q[j] starts as the column of u^j and ends orthonormal, r is upper triangular
+    std::vector<double> q(terms*length);
+    std::vector<double> r(terms*terms, 0);
+    for(size_t k=0; k<length; k++)
+    {
+        const double u = (k-centre)/scale;
+        double power = 1;
+        for(size_t j=0; j<terms; j++, power*=u)
+            q[j*length + k] = power;
+    }
+    for(size_t j=0; j<terms; j++)
+    {
+        double* column = q.data() + j*length;
+        for(size_t i=0; i<j; i++)
+        {
+            const double* previous = q.data() + i*length;
+            double dot = 0;
+            for(size_t k=0; k<length; k++)
+                dot += previous[k]*column[k];
+            for(size_t k=0; k<length; k++)
+                column[k] -= dot*previous[k];
+            r[i*terms + j] = dot;
+        }
+        
+        double norm = 0;
+        for(size_t k=0; k<length; k++)
+            norm += column[k]*column[k];
+        norm = std::sqrt(norm);
+        for(size_t k=0; k<length; k++)
+            column[k] /= norm;
+        r[j*terms + j] = norm;
+    }
+    
+    //coefficients of u^j: solve R x = Q^T by back substitution, in place of q
+    for(size_t j=terms; j-- > 0;)
+    {
+        double* row = q.data() + j*length;
+        for(size_t i=j+1; i<terms; i++)
+        {
+            const double* solved = q.data() + i*length;
+            for(size_t k=0; k<length; k++)
+                row[k] -= r[j*terms + i]*solved[k];
+        }
+        for(size_t k=0; k<length; k++)
+            row[k] /= r[j*terms + j];
+    }
+    
+    //d-th derivative of sum x_j u^j at u_t, u = (t-centre)/scale
+    std::vector<double> weights(length*length, 0);
+    for(size_t t=0; t<length; t++)
+    {
+        const double u = (t-centre)/scale;
+        double* row = weights.data() + t*length;
+        for(size_t j=derivOrder; j<terms; j++)
+        {
+            //j!/(j-d)! u^(j-d) / scale^d
+            double factor = std::pow(u, static_cast<double>(j-derivOrder))/std::pow(scale, static_cast<double>(derivOrder));
+            for(size_t i=j-derivOrder+1; i<=j; i++)
+                factor *= i;
+            
+            const double* coefficient = q.data() + j*length;
+            for(size_t k=0; k<length; k++)
+                row[k] += factor*coefficient[k];
+        }
+    }
+    
+    return weights;
+}
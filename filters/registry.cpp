@@ -0,0 +1,138 @@
+/**
+ * @file registry.cpp
+ * @brief This source file contains the list of filters selectable by name.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  
+
+#include "filters.hpp"
+#include <algorithm>
+
+/**
+ * @brief Make function that parses parameters and binds them to the kernel.
+ * @return Factory of filter runners.
+ */
+template<typename Kernel>
+std::function<FilterRunner(const std::vector<FilterParameter>&)> bindKernel()
+{
+    return [](const std::vector<FilterParameter>& params) -> FilterRunner
+    {
+        const typename Kernel::Parameters typed = Kernel::parse(params);
+        const auto run = [typed](const auto* input, const SignalLayout& layout, auto* output, ThreadPool& pool, size_t tileSize)
+        {
+            applyFilter<Kernel>(input, layout, output, pool, typed, tileSize);
+        };
+        const auto runScaled = [typed](const auto* input, const SignalLayout& layout, auto* output, const InputScale& scale, ThreadPool& pool, size_t tileSize)
+        {
+            applyFilter<Kernel>(input, layout, output, pool, typed, tileSize, scale);
+        };
+        return {run, run, runScaled, runScaled, filterRate<Kernel>(typed)};
+    };
+}
+
+/**
+ * @brief Make function that parses parameters and binds them to the streaming driver.
+ * @return Factory of stream runners.
+ */
+template<typename Kernel>
+std::function<StreamRunner(const std::vector<FilterParameter>&)> bindStreamKernel()
+{
+    return [](const std::vector<FilterParameter>& params) -> StreamRunner
+    {
+        const typename Kernel::Parameters typed = Kernel::parse(params);
+        const auto run = [typed](const auto& source, const auto& sink, ThreadPool& pool, size_t tileSize, size_t memoryBudget, size_t blockSize)
+        {
+            return streamFilter<Kernel>(source, sink, pool, typed, tileSize, memoryBudget, blockSize);
+        };
+        return {run, run};
+    };
+}
+
+/**
+ * @brief Make function that binds parameters to a recursive kernel run serially on the calling thread.
+ * Used as the reference for the parallel scan. Zero phase kernels then run backward over the output.
+ * @return Factory of filter runners.
+ */
+template<typename Kernel>
+std::function<FilterRunner(const std::vector<FilterParameter>&)> bindSerialKernel()
+{
+    return [](const std::vector<FilterParameter>& params) -> FilterRunner
+    {
+        const typename Kernel::Parameters typed = Kernel::parse(params);
+        const auto runScaled = [typed](const auto* input, const SignalLayout& layout, auto* output, const InputScale& scale, ThreadPool&, size_t)
+        {
+            if(layout.length == 0)
+                return;
+            
+            //load every channel into its output row and filter it in place, decimated output is too short for that
+            const size_t length = filteredLength<Kernel>(layout.length, typed);
+            std::vector<std::remove_pointer_t<decltype(output)>> buffer(length < layout.length ? layout.length : 0);
+            for(size_t channel=0; channel<layout.channels; channel++)
+            {
+                auto* row = output + channel*length;
+                const auto* samples = loadSamples(input + layout.channelOffset(channel), layout.length, layout.stride(), buffer.empty() ? row : buffer.data(), scale);
+                [[maybe_unused]] const double last = samples[layout.length-1];
+                const auto state = Kernel::run(samples, layout.length, row, Kernel::initialState(samples, typed), typed);
+                if constexpr(HasBackwardPass<Kernel>::value)
+                    Kernel::runBackward(row, layout.length, row, Kernel::backwardState(state, last, typed), typed);
+            }
+        };
+        const auto run = [runScaled](const auto* input, const SignalLayout& layout, auto* output, ThreadPool& pool, size_t tileSize)
+        {
+            runScaled(input, layout, output, InputScale(), pool, tileSize);
+        };
+        return {run, run, runScaled, runScaled, filterRate<Kernel>(typed)};
+    };
+}
+
+/**
+ * @brief Get list of all available filters.
+ * @return Filter list.
+ */
+const std::vector<FilterInfo>& filterRegistry()
+{
+    static const std::vector<FilterInfo> registry = 
+    {
+        {"ma-filter", "Moving average filter", bindKernel<MovingAverage>(), bindKernel<MovingAverageReference>(), bindStreamKernel<MovingAverage>()},
+        {"exp-filter", "Exponential averaging filter", bindKernel<Exponential>(), bindSerialKernel<Exponential>(), bindStreamKernel<Exponential>()},
+        {"med-filter", "Median filter", bindKernel<Median>(), bindKernel<MedianReference>(), bindStreamKernel<Median>()},
+        {"fir-filter", "FIR filter", bindKernel<Fir>(), bindKernel<FirReference>(), bindStreamKernel<Fir>()},
+        {"sg-filter", "Savitzky-Golay filter", bindKernel<SavitzkyGolay>(), bindKernel<SavitzkyGolayReference>(), bindStreamKernel<SavitzkyGolay>()},
+        {"gauss-filter", "Recursive Gaussian filter", bindKernel<Gaussian>(), bindSerialKernel<Gaussian>(), {}},
+        {"sos-filter", "Biquad cascade (second order sections) filter", bindKernel<BiquadCascade>(), bindSerialKernel<BiquadCascade>(), bindStreamKernel<BiquadCascade>()},
+        {"resample-filter", "Polyphase resampling FIR filter", bindKernel<Resampler>(), bindKernel<ResamplerReference>(), bindStreamKernel<Resampler>()}
+    };
+    
+    return registry;
+}
+
+/**
+ * @brief Find filter by name.
+ * @param name Filter name.
+ * @return Pointer to the filter or nullptr if there is no such filter.
+ */
+const FilterInfo* findFilter(const std::string& name)
+{
+    const std::vector<FilterInfo>& registry = filterRegistry();
+    auto found = std::find_if(registry.begin(), registry.end(), [&name](const FilterInfo& x) -> bool { return x.name == name; });
+    
+    if(found == registry.end())
+        return nullptr;
+    
+    return &(*found);
+}
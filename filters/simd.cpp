@@ -0,0 +1,132 @@
+/**
+ * @file simd.cpp
+ * @brief This source file contains the baseline kernel table and selection of the instruction set at run time.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#include "simd.hpp"
+#include "filters.hpp"
+#include <atomic>
+
+#define SIMD_TABLE baselineKernels
+#include "simdkernels.hpp"
+
+/**
+ * @brief Find the best instruction set supported by both the build and the CPU.
+ * @return Instruction set.
+ */
+SimdLevel detectSimdLevel()
+{
+#ifdef SIMD_DISPATCH
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+       __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("fma"))
+        return SimdLevel::AVX512;
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SimdLevel::AVX2;
+#endif
+    return SimdLevel::BASELINE;
+}
+
+/**
+ * @brief Instruction set used by the kernels. Detected on first use.
+ * @return Reference to the selected instruction set.
+ */
+static std::atomic<SimdLevel>& activeLevel()
+{
+    static std::atomic<SimdLevel> level(detectSimdLevel());
+    return level;
+}
+
+/**
+ * @brief Get instruction set used by the kernels.
+ * @return Instruction set.
+ */
+SimdLevel simdLevel()
+{
+    return activeLevel().load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Use a lower instruction set than the detected one, for example to compare the kernels.
+ * Must not be called while filters are running.
+ * @param level Instruction set.
+ * @throw InvalidParameter If the CPU or the build does not support the instruction set.
+ */
+void setSimdLevel(SimdLevel level)
+{
+    if(level > detectSimdLevel())
+        throw(InvalidParameter("Instruction set is not supported on this machine!"));
+    
+    activeLevel().store(level, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Parse instruction set name.
+ * @param name Name (baseline, avx2 or avx512).
+ * @return Instruction set.
+ * @throw InvalidParameter If the name is unknown.
+ */
+SimdLevel parseSimdLevel(const std::string& name)
+{
+    if(name == "baseline")
+        return SimdLevel::BASELINE;
+    if(name == "avx2")
+        return SimdLevel::AVX2;
+    if(name == "avx512")
+        return SimdLevel::AVX512;
+    
+    throw(InvalidParameter("Unknown instruction set! (baseline, avx2, avx512)"));
+}
+
+/**
+ * @brief Get instruction set name.
+ * @param level Instruction set.
+ * @return Name.
+ */
+const char* simdLevelName(SimdLevel level)
+{
+    switch(level)
+    {
+        case SimdLevel::AVX512: return "avx512";
+        case SimdLevel::AVX2: return "avx2";
+        default: return "baseline";
+    }
+}
+
+/**
+ * @brief Get kernel table for the selected instruction set.
+ * @return Kernel table.
+ */
+template<typename Sample>
+const SimdKernels<Sample>& simdKernels()
+{
+#ifdef SIMD_DISPATCH
+    switch(simdLevel())
+    {
+        case SimdLevel::AVX512: return avx512Kernels<Sample>();
+        case SimdLevel::AVX2: return avx2Kernels<Sample>();
+        default: break;
+    }
+#endif
+    return baselineKernels<Sample>();
+}
+
+template const SimdKernels<double>& simdKernels<double>();
+template const SimdKernels<float>& simdKernels<float>();
@@ -0,0 +1,90 @@
+/**
+ * @file simd.hpp
+ * @brief This header file contains declarations of the vectorised kernels and their run time dispatch.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#ifndef SIMD_HPP_INCLUDED
+#define SIMD_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Instruction set the vectorised kernels are compiled for.
+ */
+enum class SimdLevel
+{
+    BASELINE, /** @brief Whatever the compiler targets by default (SSE2 on x86-64). */
+    AVX2, /** @brief AVX2 (Haswell and newer). */
+    AVX512 /** @brief AVX-512 F, DQ, BW and VL (Skylake-SP, Ice Lake and newer). */
+};
+
+/** @brief Number of channels filtered side by side by the biquad cascade kernel. Same for every instruction set, so results never depend on it. */
+const size_t BIQUAD_LANES = 8;
+
+/**
+ * @brief Inner loops of the kernels compiled for a single instruction set.
+ * Every loop works on VECTOR_LANES<Sample> independent lanes, which the compiler maps to vector registers.
+ */
+template<typename Sample>
+struct SimdKernels final
+{
+    /** @brief output[i] = mean of input[i*stride-blockSize+1] ... input[i*stride]. blockSize-1 samples before input are read. */
+    void (*movingAverage)(const Sample* input, size_t count, size_t blockSize, size_t stride, Sample* output);
+    
+    /** @brief output[i] += decay^(i+1)*incoming. */
+    void (*exponentialCorrect)(Sample* output, size_t count, double incoming, double decay);
+    
+    /** @brief output[i] = median of input[i*stride] ... input[i*stride+blockSize-1]. blockSize must be accepted by isMedianNetworkSize. */
+    void (*medianNetwork)(size_t blockSize, const Sample* input, size_t count, size_t stride, Sample* output);
+    
+    /** @brief output[i] = sum of taps[j]*input[i-j]. tapCount-1 samples before input are read. */
+    void (*fir)(const Sample* input, size_t count, const double* taps, size_t tapCount, Sample* output);
+    
+    /** @brief Butterfly stages of the radix-2 FFT of n bit reversed points, twiddles of all stages one after another. */
+    void (*fftStages)(double* real, double* imag, size_t n, const double* twiddleReal, const double* twiddleImag);
+    
+    /** @brief Biquad cascade run in place over BIQUAD_LANES interleaved channels, coefficients b0 b1 b2 a1 a2 and states s1 s2 of every section. */
+    void (*biquadLanes)(double* samples, size_t count, const double* coefficients, size_t sections, double* state);
+    
+    /** @brief Polyphase FIR, output[i] is the dot product of the phase of output i with the samples ending at its input position. phaseLength-1 samples before input are read. */
+    void (*polyphase)(const Sample* input, size_t count, size_t phase, size_t up, size_t down, const double* phases, size_t phaseLength, Sample* output);
+    
+    /** @brief Number of FIR coefficients from which overlap-save FFT convolution beats the fir kernel. */
+    size_t firFftCrossover;
+};
+
+template<typename Sample>
+const SimdKernels<Sample>& baselineKernels();
+template<typename Sample>
+const SimdKernels<Sample>& avx2Kernels();
+template<typename Sample>
+const SimdKernels<Sample>& avx512Kernels();
+
+SimdLevel detectSimdLevel();
+SimdLevel simdLevel();
+void setSimdLevel(SimdLevel level);
+SimdLevel parseSimdLevel(const std::string& name);
+const char* simdLevelName(SimdLevel level);
+
+template<typename Sample>
+const SimdKernels<Sample>& simdKernels();
+
+#endif
@@ -0,0 +1,774 @@
+/**
+ * @file simdkernels.hpp
+ * @brief This header file contains inner loops of the kernels that are compiled once for every instruction set.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+// Included once by every translation unit that builds a kernel table, after defining
+// SIMD_TABLE to the name of the table function. Everything here has internal linkage,
+// so copies compiled with different instruction sets never replace each other at link time.
+// For the same reason the kernels call no inline functions from the standard library.
+
+#ifndef SIMDKERNELS_HPP_INCLUDED
+#define SIMDKERNELS_HPP_INCLUDED
+
+#ifndef SIMD_TABLE
+#error "SIMD_TABLE must be defined before including simdkernels.hpp"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include "simd.hpp"
+#include "utils.hpp"
+
+namespace
+{
+
+/**
+ * @brief Smaller of two samples, same as std::min.
+ */
+template<typename Sample>
+inline Sample lower(Sample a, Sample b)
+{
+    return b < a ? b : a;
+}
+
+/**
+ * @brief Larger of two samples, same as std::max.
+ */
+template<typename Sample>
+inline Sample upper(Sample a, Sample b)
+{
+    return a < b ? b : a;
+}
+
+/**
+ * @brief Add value to the sum, accumulating the rounding error (TwoSum) separately.
+ * Same arithmetic as CompensatedSum.
+ */
+inline void compensatedAdd(double& sum, double& compensation, double value)
+{
+    const double total = sum + value;
+    const double valuePart = total - sum;
+    compensation += (sum - (total - valuePart)) + (value - valuePart);
+    sum = total;
+}
+
+/**
+ * @brief Moving average over LANES contiguous segments of the range at once.
+ * Every lane keeps its own compensated window sum, so lanes have no dependency on each other.
+ * Samples are transposed in short blocks, so every step works on one vector of lanes.
+ * Sums are recomputed from scratch periodically, so rounding drift stays bounded.
+ * @param input First input sample. blockSize-1 samples before it are read.
+ * @param segment Number of samples in every lane.
+ * @param blockSize Number of averaged samples.
+ * @param output Output for LANES*segment samples.
+ */
+template<size_t LANES, typename Sample>
+void movingAverageLanes(const Sample* input, size_t segment, size_t blockSize, Sample* output)
+{
+    const size_t STEPS = 64;
+    const size_t resumInterval = upper<size_t>(16*blockSize, 65536);
+    
+    double sum[LANES];
+    double compensation[LANES];
+    Sample entering[STEPS][LANES];
+    Sample leaving[STEPS][LANES];
+    Sample averages[STEPS][LANES];
+    for(size_t start=0; start<segment; start+=resumInterval)
+    {
+        const size_t end = lower(start+resumInterval, segment);
+        
+        //window before the first output sample
+        for(size_t l=0; l<LANES; l++)
+        {
+            sum[l] = 0;
+            compensation[l] = 0;
+            const Sample* history = input + l*segment + start - (blockSize-1);
+            for(size_t j=0; j<blockSize-1; j++)
+                compensatedAdd(sum[l], compensation[l], history[j]);
+        }
+        
+        for(size_t block=start; block<end; block+=STEPS)
+        {
+            const size_t steps = lower(STEPS, end-block);
+            for(size_t l=0; l<LANES; l++)
+            {
+                const Sample* x = input + l*segment + block;
+                for(size_t i=0; i<steps; i++)
+                {
+                    entering[i][l] = x[i];
+                    leaving[i][l] = *(x + i - (blockSize-1));
+                }
+            }
+            
+            for(size_t i=0; i<steps; i++)
+            {
+                for(size_t l=0; l<LANES; l++)
+                {
+                    compensatedAdd(sum[l], compensation[l], entering[i][l]);
+                    averages[i][l] = static_cast<Sample>((sum[l] + compensation[l])/blockSize);
+                    compensatedAdd(sum[l], compensation[l], -leaving[i][l]);
+                }
+            }
+            
+            for(size_t l=0; l<LANES; l++)
+            {
+                for(size_t i=0; i<steps; i++)
+                    output[l*segment + block + i] = averages[i][l];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Averages of LANES windows spaced out by stride samples, every one summed from scratch.
+ * @param input Last sample of the first window.
+ * @param blockSize Number of averaged samples.
+ * @param stride Distance between the last samples of neighbouring windows.
+ * @param output Output for LANES averages.
+ */
+template<size_t LANES, typename Sample>
+inline void stridedAverages(const Sample* input, size_t blockSize, size_t stride, Sample* output)
+{
+    double sum[LANES] = {};
+    double compensation[LANES] = {};
+    const Sample* start = input - (blockSize-1);
+    for(size_t j=0; j<blockSize; j++)
+    {
+        for(size_t l=0; l<LANES; l++)
+            compensatedAdd(sum[l], compensation[l], start[l*stride + j]);
+    }
+    
+    for(size_t l=0; l<LANES; l++)
+        output[l] = static_cast<Sample>((sum[l] + compensation[l])/blockSize);
+}
+
+/**
+ * @brief Moving average of the range. Long ranges are split into one segment per lane,
+ * what is left over is done by a single lane. Spaced out windows are summed from scratch,
+ * one window per lane.
+ * @param input First input sample. blockSize-1 samples before it are read.
+ * @param count Number of output samples.
+ * @param blockSize Number of averaged samples.
+ * @param stride Distance between the input samples of neighbouring output samples.
+ * @param output Output samples.
+ */
+template<typename Sample>
+void movingAverage(const Sample* input, size_t count, size_t blockSize, size_t stride, Sample* output)
+{
+    const size_t LANES = VECTOR_LANES<Sample>;
+    if(stride > 1)
+    {
+        size_t i = 0;
+        for(; i+LANES<=count; i+=LANES)
+            stridedAverages<LANES>(input + i*stride, blockSize, stride, output+i);
+        
+        for(; i<count; i++)
+            stridedAverages<1>(input + i*stride, blockSize, stride, output+i);
+        return;
+    }
+    
+    //every lane sums its own first window, so split only when segments are much longer than the window
+    const size_t segment = count/LANES;
+    size_t done = 0;
+    if(segment >= 4*blockSize)
+    {
+        movingAverageLanes<LANES>(input, segment, blockSize, output);
+        done = LANES*segment;
+    }
+    movingAverageLanes<1>(input+done, count-done, blockSize, output+done);
+}
+
+/**
+ * @brief Add decay of the incoming state, decay^(i+1)*incoming, to the output.
+ * Lanes advance by decay^lanes so there is no dependency between neighbouring samples.
+ * Stops early only once the correction has underflowed to subnormal values.
+ * @param output Output computed from zero state.
+ * @param count Number of samples.
+ * @param incoming State before the range.
+ * @param decay Decay of the state per sample.
+ */
+template<typename Sample>
+void exponentialCorrect(Sample* output, size_t count, double incoming, double decay)
+{
+    const size_t LANES = VECTOR_LANES<Sample>;
+    constexpr Sample SMALLEST = std::numeric_limits<Sample>::min();
+    
+    Sample lanes[LANES];
+    double lane = decay*incoming;
+    for(size_t l=0; l<LANES; l++, lane*=decay)
+        lanes[l] = static_cast<Sample>(lane);
+    const Sample step = static_cast<Sample>(std::pow(decay, static_cast<double>(LANES)));
+    
+    size_t i = 0;
+    for(; i+LANES<=count; i+=LANES)
+    {
+        for(size_t l=0; l<LANES; l++)
+        {
+            output[i+l] += lanes[l];
+            lanes[l] *= step;
+        }
+        
+        //stop once the correction underflows, a threshold relative to the output would drop it from later
+        //outputs close to zero and make results depend on where the range starts
+        if(lanes[0] < SMALLEST && lanes[0] > -SMALLEST)
+            return;
+    }
+    
+    for(size_t l=0; i<count; i++, l++)
+        output[i] += lanes[l];
+}
+
+/**
+ * @brief FIR filter of GROUP neighbouring outputs. Sums stay in registers over all taps
+ * and the GROUP+tapCount-1 input samples they read stay in L1 cache.
+ * @param input First input sample. tapCount-1 samples before it are read.
+ * @param taps Coefficients.
+ * @param tapCount Number of coefficients.
+ * @param output Output for GROUP samples.
+ */
+template<size_t GROUP, typename Sample>
+inline void firGroup(const Sample* input, const double* taps, size_t tapCount, Sample* output)
+{
+    Sample sums[GROUP];
+    for(size_t l=0; l<GROUP; l++)
+        sums[l] = 0;
+    
+    for(size_t j=0; j<tapCount; j++)
+    {
+        const Sample c = static_cast<Sample>(taps[j]);
+        const Sample* x = input - j;
+        for(size_t l=0; l<GROUP; l++)
+            sums[l] += c*x[l];
+    }
+    
+    for(size_t l=0; l<GROUP; l++)
+        output[l] = sums[l];
+}
+
+/**
+ * @brief Direct form FIR filter, four vector registers of outputs at a time.
+ * Every output sums the taps in the same order, so results do not depend on the grouping.
+ * @param input First input sample. tapCount-1 samples before it are read.
+ * @param count Number of samples.
+ * @param taps Coefficients.
+ * @param tapCount Number of coefficients.
+ * @param output Output samples.
+ */
+template<typename Sample>
+void fir(const Sample* input, size_t count, const double* taps, size_t tapCount, Sample* output)
+{
+    const size_t GROUP = 4*VECTOR_LANES<Sample>;
+    
+    size_t i = 0;
+    for(; i+GROUP<=count; i+=GROUP)
+        firGroup<GROUP>(input+i, taps, tapCount, output+i);
+    
+    for(; i<count; i++)
+        firGroup<1>(input+i, taps, tapCount, output+i);
+}
+
+/**
+ * @brief Dot product of coefficients and samples, accumulated in the sample type.
+ * Partial sums are kept in a fixed number of lanes and combined pairwise,
+ * so the result is the same for every instruction set.
+ * @param taps Coefficients.
+ * @param input Samples.
+ * @param length Number of coefficients and samples.
+ * @return Dot product.
+ */
+template<typename Sample>
+inline Sample dotProduct(const double* taps, const Sample* input, size_t length)
+{
+    const size_t LANES = 8;
+    
+    Sample sums[LANES];
+    for(size_t l=0; l<LANES; l++)
+        sums[l] = 0;
+    
+    size_t i = 0;
+    for(; i+LANES<=length; i+=LANES)
+    {
+        for(size_t l=0; l<LANES; l++)
+            sums[l] += static_cast<Sample>(taps[i+l])*input[i+l];
+    }
+    for(; i<length; i++)
+        sums[i%LANES] += static_cast<Sample>(taps[i])*input[i];
+    
+    for(size_t width=LANES/2; width>0; width/=2)
+    {
+        for(size_t l=0; l<width; l++)
+            sums[l] += sums[l+width];
+    }
+    return sums[0];
+}
+
+/**
+ * @brief Polyphase resampling FIR. Every output needs one phase of the coefficients applied to the
+ * phaseLength samples ending at its input position, which then moves by down/up samples.
+ * @param input Input sample at the position of the first output. phaseLength-1 samples before it are read.
+ * @param count Number of output samples.
+ * @param phase Phase of the first output, < up.
+ * @param up Interpolation factor.
+ * @param down Decimation factor.
+ * @param phases Coefficients of every phase, oldest sample first.
+ * @param phaseLength Number of coefficients of every phase.
+ * @param output Output samples.
+ */
+template<typename Sample>
+void polyphase(const Sample* input, size_t count, size_t phase, size_t up, size_t down, const double* phases, size_t phaseLength, Sample* output)
+{
+    for(size_t i=0; i<count; i++)
+    {
+        output[i] = dotProduct(phases + phase*phaseLength, input - (phaseLength-1), phaseLength);
+        phase += down;
+        input += phase/up;
+        phase %= up;
+    }
+}
+
+/**
+ * @brief Radix-2 butterflies between two halves of one FFT group.
+ * Pointers never alias, which lets the loop vectorize.
+ * @param ar Real part of the lower half.
+ * @param ai Imaginary part of the lower half.
+ * @param br Real part of the upper half.
+ * @param bi Imaginary part of the upper half.
+ * @param wr Real part of the stage twiddles.
+ * @param wi Imaginary part of the stage twiddles.
+ * @param half Number of butterflies.
+ */
+inline void fftButterflies(double* __restrict ar, double* __restrict ai, double* __restrict br, double* __restrict bi,
+                           const double* __restrict wr, const double* __restrict wi, size_t half)
+{
+    for(size_t k=0; k<half; k++)
+    {
+        const double tr = br[k]*wr[k] - bi[k]*wi[k];
+        const double ti = br[k]*wi[k] + bi[k]*wr[k];
+        br[k] = ar[k] - tr;
+        bi[k] = ai[k] - ti;
+        ar[k] = ar[k] + tr;
+        ai[k] = ai[k] + ti;
+    }
+}
+
+/**
+ * @brief Butterfly stages of the radix-2 decimation in time FFT.
+ * First two stages need no multiplication and are done together, later ones run
+ * over contiguous halves, so the butterflies of a stage map to vector registers.
+ * @param real Real parts of n bit reversed points.
+ * @param imag Imaginary parts of n bit reversed points.
+ * @param n Number of points, at least 4.
+ * @param twiddleReal Real parts of the twiddle factors of all stages.
+ * @param twiddleImag Imaginary parts of the twiddle factors of all stages.
+ */
+inline void fftStages(double* real, double* imag, size_t n, const double* twiddleReal, const double* twiddleImag)
+{
+    //radix-4 butterfly with twiddles 1 and -i
+    for(size_t i=0; i<n; i+=4)
+    {
+        const double ar = real[i] + real[i+1], ai = imag[i] + imag[i+1];
+        const double br = real[i] - real[i+1], bi = imag[i] - imag[i+1];
+        const double cr = real[i+2] + real[i+3], ci = imag[i+2] + imag[i+3];
+        const double dr = real[i+2] - real[i+3], di = imag[i+2] - imag[i+3];
+        real[i] = ar + cr;
+        imag[i] = ai + ci;
+        real[i+2] = ar - cr;
+        imag[i+2] = ai - ci;
+        real[i+1] = br + di;
+        imag[i+1] = bi - dr;
+        real[i+3] = br - di;
+        imag[i+3] = bi + dr;
+    }
+    
+    for(size_t half=4; half<n; half<<=1)
+    {
+        for(size_t start=0; start<n; start+=2*half)
+            fftButterflies(real + start, imag + start, real + start + half, imag + start + half,
+                           twiddleReal + half - 1, twiddleImag + half - 1, half);
+    }
+}
+
+/**
+ * @brief G consecutive biquad sections in transposed direct form II over BIQUAD_LANES channels.
+ * Coefficients and states of the group stay in registers for the whole range, and the recurrences
+ * of different sections overlap, since every section only waits for its own state from the previous sample.
+ * @param samples Interleaved samples, replaced by the output of the group.
+ * @param count Number of samples in every lane.
+ * @param coefficients b0, b1, b2, a1, a2 of every section of the group.
+ * @param state s1 and s2 of every section of the group, BIQUAD_LANES values each. Updated.
+ */
+template<size_t G>
+void biquadGroup(double* samples, size_t count, const double* coefficients, double* state)
+{
+    const size_t LANES = BIQUAD_LANES;
+    
+    double b0[G], b1[G], b2[G], a1[G], a2[G];
+    double s1[G][LANES], s2[G][LANES];
+    for(size_t g=0; g<G; g++)
+    {
+        b0[g] = coefficients[5*g];
+        b1[g] = coefficients[5*g+1];
+        b2[g] = coefficients[5*g+2];
+        a1[g] = coefficients[5*g+3];
+        a2[g] = coefficients[5*g+4];
+        for(size_t lane=0; lane<LANES; lane++)
+        {
+            s1[g][lane] = state[2*g*LANES + lane];
+            s2[g][lane] = state[(2*g+1)*LANES + lane];
+        }
+    }
+    
+    for(size_t i=0; i<count; i++)
+    {
+        double x[LANES];
+        for(size_t lane=0; lane<LANES; lane++)
+            x[lane] = samples[i*LANES + lane];
+        
+        for(size_t g=0; g<G; g++)
+        {
+            //kept as a loop, so it becomes vector instructions instead of unrolled scalar ones
+            #pragma GCC unroll 1
+            for(size_t lane=0; lane<LANES; lane++)
+            {
+                const double y = b0[g]*x[lane] + s1[g][lane];
+                s1[g][lane] = (b1[g]*x[lane] + s2[g][lane]) - a1[g]*y;
+                s2[g][lane] = b2[g]*x[lane] - a2[g]*y;
+                x[lane] = y;
+            }
+        }
+        
+        for(size_t lane=0; lane<LANES; lane++)
+            samples[i*LANES + lane] = x[lane];
+    }
+    
+    for(size_t g=0; g<G; g++)
+    {
+        for(size_t lane=0; lane<LANES; lane++)
+        {
+            state[2*g*LANES + lane] = s1[g][lane];
+            state[(2*g+1)*LANES + lane] = s2[g][lane];
+        }
+    }
+}
+
+/**
+ * @brief Biquad cascade over BIQUAD_LANES channels stored sample by sample (samples[i*BIQUAD_LANES + lane]).
+ * Sections are run in groups of up to four. Arithmetic of every lane is the same as in the scalar
+ * recurrence, so the channels come out exactly as if they were filtered one by one.
+ * @param samples Interleaved samples, replaced by the output.
+ * @param count Number of samples in every lane.
+ * @param coefficients b0, b1, b2, a1, a2 of every section, normalised by a0.
+ * @param sections Number of sections.
+ * @param state s1 and s2 of every section, BIQUAD_LANES values each. Updated.
+ */
+inline void biquadLanes(double* samples, size_t count, const double* coefficients, size_t sections, double* state)
+{
+    size_t s = 0;
+    for(; s+4<=sections; s+=4)
+        biquadGroup<4>(samples, count, coefficients + 5*s, state + 2*s*BIQUAD_LANES);
+    for(; s+2<=sections; s+=2)
+        biquadGroup<2>(samples, count, coefficients + 5*s, state + 2*s*BIQUAD_LANES);
+    for(; s<sections; s++)
+        biquadGroup<1>(samples, count, coefficients + 5*s, state + 2*s*BIQUAD_LANES);
+}
+
+/** @brief Which outputs of a compare-exchange are used later in the network. */
+enum class ComparatorKind : unsigned char
+{
+    BOTH, /** @brief Min and max are both needed. */
+    MIN_ONLY, /** @brief Only min (lower wire) is needed. */
+    MAX_ONLY /** @brief Only max (upper wire) is needed. */
+};
+
+/**
+ * @brief Compare-exchange element of the network. Puts min on the lower wire and max on the upper one.
+ */
+struct Comparator
+{
+    size_t low; /** @brief Lower wire. */
+    size_t high; /** @brief Upper wire. */
+    ComparatorKind kind; /** @brief Outputs that are used. */
+};
+
+/**
+ * @brief Selection network that leaves the median of N inputs on wire N/2.
+ */
+template<size_t N>
+struct MedianNetwork
+{
+    static constexpr size_t WIRES = [](){ size_t p = 1; while(p < N) p <<= 1; return p; }();
+    static constexpr size_t CAPACITY = WIRES*WIRES;
+
+    std::array<Comparator, CAPACITY> comparators = {};
+    size_t count = 0;
+};
+
+/**
+ * @brief Build median selection network for N inputs.
+ * Batcher's odd-even merge sort is generated for the next power of two, comparators
+ * touching the padding wires are dropped (padding behaves as +inf), and comparators
+ * that do not influence the middle wire are pruned in a backward pass.
+ * @return Median network.
+ */
+template<size_t N>
+constexpr MedianNetwork<N> makeMedianNetwork()
+{
+    constexpr size_t P = MedianNetwork<N>::WIRES;
+
+    //full sorting network
+    MedianNetwork<N> sorting;
+    for(size_t p=1; p<P; p<<=1)
+    {
+        for(size_t k=p; k>=1; k>>=1)
+        {
+            for(size_t j=k%p; j+k<P; j+=2*k)
+            {
+                for(size_t i=0; i<k && i+j+k<P; i++)
+                {
+                    if((i+j)/(2*p) == (i+j+k)/(2*p) && i+j+k < N)
+                        sorting.comparators[sorting.count++] = {i+j, i+j+k, ComparatorKind::BOTH};
+                }
+            }
+        }
+    }
+
+    //prune everything that does not lead to the median wire
+    std::array<bool, P> needed = {};
+    needed[N/2] = true;
+    std::array<bool, MedianNetwork<N>::CAPACITY> keep = {};
+    for(size_t i=sorting.count; i>0; i--)
+    {
+        Comparator& c = sorting.comparators[i-1];
+        if(!needed[c.low] && !needed[c.high])
+            continue;
+        
+        if(!needed[c.high])
+            c.kind = ComparatorKind::MIN_ONLY;
+        else if(!needed[c.low])
+            c.kind = ComparatorKind::MAX_ONLY;
+        
+        needed[c.low] = true;
+        needed[c.high] = true;
+        keep[i-1] = true;
+    }
+
+    MedianNetwork<N> network;
+    for(size_t i=0; i<sorting.count; i++)
+    {
+        if(keep[i])
+            network.comparators[network.count++] = sorting.comparators[i];
+    }
+    
+    return network;
+}
+
+/**
+ * @brief Compile time instance of the network.
+ */
+template<size_t N>
+struct MedianNetworkInstance
+{
+    static constexpr MedianNetwork<N> value = makeMedianNetwork<N>();
+};
+
+/**
+ * @brief Smaller of two samples in the order of the median filters, NaN after all numbers.
+ */
+template<typename Sample>
+inline Sample medianLower(Sample a, Sample b)
+{
+    return (b < a || a != a) ? b : a;
+}
+
+/**
+ * @brief Larger of two samples in the order of the median filters, NaN after all numbers.
+ */
+template<typename Sample>
+inline Sample medianUpper(Sample a, Sample b)
+{
+    return (a < b || b != b) ? b : a;
+}
+
+/**
+ * @brief Apply single comparator to all lanes.
+ * @param wires Network wires, one value per lane.
+ */
+template<size_t N, size_t LANES, bool NAN_LAST, size_t I, typename Sample>
+inline void compareExchange(Sample (&wires)[N][LANES])
+{
+    constexpr Comparator c = MedianNetworkInstance<N>::value.comparators[I];
+    for(size_t l=0; l<LANES; l++)
+    {
+        const Sample a = wires[c.low][l];
+        const Sample b = wires[c.high][l];
+        if constexpr(c.kind != ComparatorKind::MAX_ONLY)
+            wires[c.low][l] = NAN_LAST ? medianLower(a, b) : lower(a, b);
+        if constexpr(c.kind != ComparatorKind::MIN_ONLY)
+            wires[c.high][l] = NAN_LAST ? medianUpper(a, b) : upper(a, b);
+    }
+}
+
+/**
+ * @brief Apply the whole network, fully unrolled.
+ * @param wires Network wires, one value per lane.
+ */
+template<size_t N, size_t LANES, bool NAN_LAST, typename Sample, size_t... I>
+inline void runNetwork(Sample (&wires)[N][LANES], std::index_sequence<I...>)
+{
+    (compareExchange<N, LANES, NAN_LAST, I>(wires), ...);
+}
+
+/**
+ * @brief Compute medians of LANES windows at once.
+ * @param input First sample of the first window.
+ * @param stride Distance between the first samples of neighbouring windows.
+ * @param output Output for LANES medians.
+ */
+template<size_t N, size_t LANES, bool NAN_LAST, typename Sample>
+inline void medianBlock(const Sample* input, size_t stride, Sample* output)
+{
+    Sample wires[N][LANES];
+    for(size_t j=0; j<N; j++)
+    {
+        for(size_t l=0; l<LANES; l++)
+            wires[j][l] = input[l*stride + j];
+    }
+
+    runNetwork<N, LANES, NAN_LAST>(wires, std::make_index_sequence<MedianNetworkInstance<N>::value.count>());
+
+    for(size_t l=0; l<LANES; l++)
+        output[l] = wires[N/2][l];
+}
+
+/**
+ * @brief Compute medians of count windows of N samples.
+ * One vector register of windows is computed at once, so float32 signals take twice as many lanes.
+ * @param input First sample of the first window.
+ * @param count Number of windows.
+ * @param stride Distance between the first samples of neighbouring windows.
+ * @param output Output for the medians.
+ */
+template<size_t N, bool NAN_LAST, typename Sample>
+void medianWindows(const Sample* input, size_t count, size_t stride, Sample* output)
+{
+    const size_t LANES = VECTOR_LANES<Sample>;
+    size_t i = 0;
+    for(; i+LANES<=count; i+=LANES)
+        medianBlock<N, LANES, NAN_LAST>(input+i*stride, stride, output+i);
+    
+    for(; i<count; i++)
+        medianBlock<N, 1, NAN_LAST>(input+i*stride, stride, output+i);
+}
+
+/**
+ * @brief Compute medians of count windows of N samples, NaN ordered after all numbers.
+ * Plain min and max are cheaper than the NaN ordering, so windows are taken in chunks
+ * and only chunks holding a NaN go through the NaN aware network.
+ * @param input First sample of the first window. (count-1)*stride+N samples are read.
+ * @param count Number of windows.
+ * @param stride Distance between the first samples of neighbouring windows.
+ * @param output Output for the medians.
+ */
+template<size_t N, typename Sample>
+void medianNetwork(const Sample* input, size_t count, size_t stride, Sample* output)
+{
+    const size_t CHUNK = 1024;
+    for(size_t i=0; i<count; i+=CHUNK)
+    {
+        const size_t windows = lower(CHUNK, count-i);
+        const Sample* start = input + i*stride;
+        const size_t span = (windows-1)*stride + N;
+        
+        bool nan = false;
+        for(size_t j=0; j<span; j++)
+            nan |= start[j] != start[j];
+        
+        //called through a pointer, so both networks are compiled on their own and keep their wires in registers
+        const auto run = nan ? medianWindows<N, true, Sample> : medianWindows<N, false, Sample>;
+        run(start, windows, stride, output+i);
+    }
+}
+
+/**
+ * @brief Median of small windows computed by a sorting network.
+ * @param blockSize Window size. Must be accepted by isMedianNetworkSize.
+ * @param input First sample of the first window.
+ * @param count Number of windows.
+ * @param stride Distance between the first samples of neighbouring windows.
+ * @param output Output for the medians.
+ */
+template<typename Sample>
+void medianNetworkKernel(size_t blockSize, const Sample* input, size_t count, size_t stride, Sample* output)
+{
+    switch(blockSize)
+    {
+        case 3: medianNetwork<3>(input, count, stride, output); break;
+        case 5: medianNetwork<5>(input, count, stride, output); break;
+        case 7: medianNetwork<7>(input, count, stride, output); break;
+        case 9: medianNetwork<9>(input, count, stride, output); break;
+        case 15: medianNetwork<15>(input, count, stride, output); break;
+        case 25: medianNetwork<25>(input, count, stride, output); break;
+    }
+}
+
+/**
+ * @brief Number of FIR coefficients from which overlap-save FFT convolution beats the fir kernel
+ * of this instruction set. Measured on one core, wider vectors speed up the direct convolution more.
+ */
+#if defined(__AVX512F__)
+const size_t FIR_FFT_CROSSOVER_DOUBLE = 112;
+const size_t FIR_FFT_CROSSOVER_FLOAT = 176;
+#elif defined(__AVX2__)
+const size_t FIR_FFT_CROSSOVER_DOUBLE = 112;
+const size_t FIR_FFT_CROSSOVER_FLOAT = 160;
+#else
+const size_t FIR_FFT_CROSSOVER_DOUBLE = 80;
+const size_t FIR_FFT_CROSSOVER_FLOAT = 128;
+#endif
+
+}
+
+/**
+ * @brief Kernel table compiled for the instruction set of this translation unit.
+ * @return Kernel table.
+ */
+template<>
+const SimdKernels<double>& SIMD_TABLE<double>()
+{
+    static const SimdKernels<double> kernels = {movingAverage<double>, exponentialCorrect<double>, medianNetworkKernel<double>, fir<double>, fftStages, biquadLanes, polyphase<double>, FIR_FFT_CROSSOVER_DOUBLE};
+    return kernels;
+}
+
+/**
+ * @brief Kernel table compiled for the instruction set of this translation unit.
+ * @return Kernel table.
+ */
+template<>
+const SimdKernels<float>& SIMD_TABLE<float>()
+{
+    static const SimdKernels<float> kernels = {movingAverage<float>, exponentialCorrect<float>, medianNetworkKernel<float>, fir<float>, fftStages, biquadLanes, polyphase<float>, FIR_FFT_CROSSOVER_FLOAT};
+    return kernels;
+}
+
+#endif
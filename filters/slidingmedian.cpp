@@ -0,0 +1,144 @@
+/**
+ * @file slidingmedian.cpp
+ * @brief This source file contains code for the sliding median structure.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.  
+
+#include "slidingmedian.hpp"
+#include <iterator>
+
+/**
+ * @brief Constructor.
+ * @param windowSize Number of samples in the full window. Must not be zero.
+ */
+SlidingMedian::SlidingMedian(size_t windowSize):
+middle(tree.end()),
+slots(windowSize)
+{
+}
+
+/**
+ * @brief Remove all samples.
+ */
+void SlidingMedian::clear()
+{
+    tree.clear();
+    middle = tree.end();
+    pushed = 0;
+}
+
+/**
+ * @brief Add sample to the window. Once the window is full the oldest sample leaves it.
+ * @param value Sample value.
+ */
+void SlidingMedian::push(double value)
+{
+    const size_t windowSize = slots.size();
+    Tree::iterator& slot = slots[pushed%windowSize];
+    const Entry entry(value, pushed++);
+    
+    if(tree.size() < windowSize)
+    {
+        slot = tree.insert(entry).first;
+        insert(slot);
+        return;
+    }
+    
+    //take node of the oldest sample and put it back with the new value
+    erase(slot);
+    auto node = tree.extract(slot);
+    node.value() = entry;
+    slot = tree.insert(std::move(node)).position;
+    insert(slot);
+}
+
+/**
+ * @brief Get median of the window. Window must not be empty.
+ * @return Middle sample for odd window sizes, average of the two middle samples otherwise.
+ */
+double SlidingMedian::median() const
+{
+    if(tree.size()%2)
+        return middle->first;
+    
+    return (middle->first + std::next(middle)->first)/2;
+}
+
+/**
+ * @brief Get number of samples in the window.
+ * @return Window size.
+ */
+size_t SlidingMedian::size() const
+{
+    return tree.size();
+}
+
+/**
+ * @brief Order samples by value and then by arrival.
+ * @param a First sample.
+ * @param b Second sample.
+ * @return True if a goes before b.
+ */
+bool SlidingMedian::Order::operator()(const Entry& a, const Entry& b) const
+{
+    if(medianLess(a.first, b.first))
+        return true;
+    if(medianLess(b.first, a.first))
+        return false;
+    
+    return a.second < b.second;
+}
+
+/**
+ * @brief Move the middle after a sample has been inserted, so it points at index (size-1)/2 again.
+ * @param position Inserted sample.
+ */
+void SlidingMedian::insert(Tree::iterator position)
+{
+    const size_t previousSize = tree.size()-1;
+    if(previousSize == 0)
+        middle = position;
+    else if(Order()(*position, *middle))
+    {
+        if(previousSize%2)
+            --middle;
+    }
+    else if(previousSize%2 == 0)
+        ++middle;
+}
+
+/**
+ * @brief Move the middle before a sample is removed, so it points at index (size-1)/2 afterwards.
+ * @param position Sample that is about to be removed.
+ */
+void SlidingMedian::erase(Tree::iterator position)
+{
+    const size_t size = tree.size();
+    if(size == 1)
+        middle = tree.end();
+    else if(position == middle)
+        middle = size%2 ? std::prev(middle) : std::next(middle);
+    else if(Order()(*position, *middle))
+    {
+        if(size%2 == 0)
+            ++middle;
+    }
+    else if(size%2)
+        --middle;
+}
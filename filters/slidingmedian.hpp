@@ -0,0 +1,83 @@
+/**
+ * @file slidingmedian.hpp
+ * @brief This header file contains declaration of the sliding median structure.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#ifndef SLIDINGMEDIAN_HPP_INCLUDED
+#define SLIDINGMEDIAN_HPP_INCLUDED
+
+#include <set>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/**
+ * @brief Order of the samples of every median filter. NaN goes after all numbers,
+ * so the order stays strict and results don't depend on how the window is selected.
+ * @param a First sample.
+ * @param b Second sample.
+ * @return True if a goes before b.
+ */
+template<typename Sample>
+inline bool medianLess(Sample a, Sample b)
+{
+    return a < b || (b != b && a == a);
+}
+
+/**
+ * @brief Median of a sliding window in O(log k) per update.
+ * Window is kept in one ordered tree with an iterator to its lower middle sample.
+ * Every slot of the window remembers the iterator of its sample, so the oldest
+ * sample is removed without searching for its value. Samples are ordered by medianLess
+ * and then by arrival, which keeps the order total.
+ * Replacing a sample reuses the tree node, so sliding the window does not allocate.
+ */
+class SlidingMedian final
+{
+public:
+    explicit SlidingMedian(size_t windowSize);
+    void clear();
+    void push(double value);
+    double median() const;
+    size_t size() const;
+
+private:
+    typedef std::pair<double, size_t> Entry;
+    
+    /**
+     * @brief Strict total order of the window samples.
+     */
+    struct Order
+    {
+        bool operator()(const Entry& a, const Entry& b) const;
+    };
+    
+    typedef std::set<Entry, Order> Tree;
+    
+    void insert(Tree::iterator position);
+    void erase(Tree::iterator position);
+
+    Tree tree;
+    Tree::iterator middle;
+    std::vector<Tree::iterator> slots;
+    size_t pushed = 0;
+};
+
+#endif
@@ -0,0 +1,361 @@
+/**
+ * @file stream.cpp
+ * @brief This source file contains stateful filters that process a live signal block by block.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#include "stream.hpp"
+#include <algorithm>
+
+/**
+ * @brief Filter the block and record how long it took.
+ * @param input Input samples.
+ * @param count Number of samples.
+ * @param output Output buffer. Must hold count samples.
+ * @return Number of samples written to the output.
+ */
+template<typename Sample>
+size_t StatefulFilter<Sample>::push(const Sample* input, size_t count, Sample* output)
+{
+    StopWatch watch;
+    watch.start();
+    const size_t emitted = process(input, count, output);
+    watch.stop();
+    
+    statistics.blocks++;
+    statistics.samples += count;
+    statistics.lastTime = watch.getTime();
+    statistics.totalTime += statistics.lastTime;
+    statistics.maxTime = std::max(statistics.maxTime, statistics.lastTime);
+    return emitted;
+}
+
+/**
+ * @brief Filter the block and record how long it took.
+ * @param input Input samples.
+ * @return Output samples ready after this block.
+ */
+template<typename Sample>
+std::vector<Sample> StatefulFilter<Sample>::push(const std::vector<Sample>& input)
+{
+    std::vector<Sample> output(input.size());
+    output.resize(push(input.data(), input.size(), output.data()));
+    return output;
+}
+
+/**
+ * @brief End the signal. Writes out the samples held back by the delay and resets the filter.
+ * @param output Output buffer. Must hold delay() samples.
+ * @return Number of samples written to the output.
+ */
+template<typename Sample>
+size_t StatefulFilter<Sample>::flush(Sample* output)
+{
+    const size_t emitted = drain(output);
+    reset();
+    return emitted;
+}
+
+/**
+ * @brief End the signal. Returns the samples held back by the delay and resets the filter.
+ * @return Remaining output samples.
+ */
+template<typename Sample>
+std::vector<Sample> StatefulFilter<Sample>::flush()
+{
+    std::vector<Sample> output(delay());
+    output.resize(flush(output.data()));
+    return output;
+}
+
+/**
+ * @brief Get processing time of the blocks pushed since creation or last reset.
+ * @return Block latency statistics.
+ */
+template<typename Sample>
+const BlockLatency& StatefulFilter<Sample>::latency() const
+{
+    return statistics;
+}
+
+/**
+ * @brief Reset block latency statistics.
+ */
+template<typename Sample>
+void StatefulFilter<Sample>::resetLatency()
+{
+    statistics = BlockLatency();
+}
+
+/**
+ * @brief Create moving average filter.
+ * @param params_ Parameters.
+ */
+template<typename Sample>
+MovingAverageStream<Sample>::MovingAverageStream(const MovingAverageParameters& params_):
+params(params_),
+history(2*params_.blockSize),
+sum(params_.blockSize)
+{
+}
+
+/**
+ * @brief Moving average uses only past samples.
+ * @return Zero.
+ */
+template<typename Sample>
+size_t MovingAverageStream<Sample>::delay() const
+{
+    return 0;
+}
+
+/**
+ * @brief Forget the signal seen so far.
+ */
+template<typename Sample>
+void MovingAverageStream<Sample>::reset()
+{
+    seen = 0;
+    std::fill(history.begin(), history.end(), 0);
+    sum = SlidingSum(params.blockSize);
+}
+
+/**
+ * @brief Slide the window sum over the block. Every sample is stored twice, blockSize slots
+ * apart, so the window is always contiguous and is resummed in the same order as by the batch filter.
+ * History before the start of the signal is zero, so the first windows need no special case.
+ * @param input Input samples.
+ * @param count Number of samples.
+ * @param output Output buffer.
+ * @return Number of output samples, always count.
+ */
+template<typename Sample>
+size_t MovingAverageStream<Sample>::process(const Sample* input, size_t count, Sample* output)
+{
+    const size_t blockSize = params.blockSize;
+    
+    for(size_t i=0; i<count; i++, seen++)
+    {
+        const size_t slot = seen%blockSize;
+        const Sample leaving = history[slot];
+        history[slot] = history[slot+blockSize] = input[i];
+        
+        if(sum.stale())
+            sum.resum(history.data()+slot+1, history.data()+slot+1+blockSize);
+        else
+            sum.slide(input[i], leaving);
+        
+        //history clipped by the start of the signal
+        output[i] = seen < blockSize-1 ? input[i] : static_cast<Sample>(sum.value()/blockSize);
+    }
+    
+    return count;
+}
+
+/**
+ * @brief Moving average holds nothing back.
+ * @return Zero.
+ */
+template<typename Sample>
+size_t MovingAverageStream<Sample>::drain(Sample*)
+{
+    return 0;
+}
+
+/**
+ * @brief Create exponential filter.
+ * @param params_ Parameters.
+ */
+template<typename Sample>
+ExponentialStream<Sample>::ExponentialStream(const ExponentialParameters& params_):
+params(params_)
+{
+}
+
+/**
+ * @brief Exponential filter uses only past samples.
+ * @return Zero.
+ */
+template<typename Sample>
+size_t ExponentialStream<Sample>::delay() const
+{
+    return 0;
+}
+
+/**
+ * @brief Forget the signal seen so far.
+ */
+template<typename Sample>
+void ExponentialStream<Sample>::reset()
+{
+    started = false;
+}
+
+/**
+ * @brief Run the recurrence over the block, starting from the state left by the previous one.
+ * @param input Input samples.
+ * @param count Number of samples.
+ * @param output Output buffer.
+ * @return Number of output samples, always count.
+ */
+template<typename Sample>
+size_t ExponentialStream<Sample>::process(const Sample* input, size_t count, Sample* output)
+{
+    if(count == 0)
+        return 0;
+    
+    if(!started)
+    {
+        state = Exponential::initialState(input, params);
+        started = true;
+    }
+    state = Exponential::run(input, count, output, state, params);
+    return count;
+}
+
+/**
+ * @brief Exponential filter holds nothing back.
+ * @return Zero.
+ */
+template<typename Sample>
+size_t ExponentialStream<Sample>::drain(Sample*)
+{
+    return 0;
+}
+
+/**
+ * @brief Create median filter.
+ * @param params_ Parameters.
+ */
+template<typename Sample>
+MedianStream<Sample>::MedianStream(const MedianParameters& params_):
+params(params_),
+window(params_.blockSize),
+median(params_.blockSize)
+{
+}
+
+/**
+ * @brief Output sample is known once the whole window after it has been pushed.
+ * @return blockSize-1.
+ */
+template<typename Sample>
+size_t MedianStream<Sample>::delay() const
+{
+    return params.blockSize-1;
+}
+
+/**
+ * @brief Forget the signal seen so far.
+ */
+template<typename Sample>
+void MedianStream<Sample>::reset()
+{
+    seen = 0;
+    median.clear();
+}
+
+/**
+ * @brief Slide the window over the block. Every sample completes the window of the sample
+ * blockSize-1 places before it, whose median is emitted.
+ * @param input Input samples.
+ * @param count Number of samples.
+ * @param output Output buffer.
+ * @return Number of output samples.
+ */
+template<typename Sample>
+size_t MedianStream<Sample>::process(const Sample* input, size_t count, Sample* output)
+{
+    const size_t blockSize = params.blockSize;
+    
+    size_t emitted = 0;
+    for(size_t i=0; i<count; i++, seen++)
+    {
+        window[seen%blockSize] = input[i];
+        median.push(input[i]);
+        
+        if(seen >= blockSize-1)
+            output[emitted++] = static_cast<Sample>(median.median());
+    }
+    
+    return emitted;
+}
+
+/**
+ * @brief Copy the samples whose window is clipped by the end of the signal.
+ * @param output Output buffer.
+ * @return Number of output samples.
+ */
+template<typename Sample>
+size_t MedianStream<Sample>::drain(Sample* output)
+{
+    const size_t blockSize = params.blockSize;
+    const size_t held = std::min(seen, blockSize-1);
+    for(size_t i=0; i<held; i++)
+        output[i] = window[(seen-held+i)%blockSize];
+    
+    return held;
+}
+
+/**
+ * @brief Check that every output sample is asked for, stateful filters emit one per input sample.
+ * @param params Parameters.
+ * @return Parameters.
+ * @throw InvalidParameter If the parameters ask for decimation.
+ */
+template<typename Parameters>
+static const Parameters& undecimated(const Parameters& params)
+{
+    if(params.decimation != 1)
+        throw(InvalidParameter("Stateful filters can't decimate!"));
+    
+    return params;
+}
+
+/**
+ * @brief Create stateful filter by name.
+ * @param name Filter name, same as in the filter registry.
+ * @param params Parameters.
+ * @return Filter or nullptr if there is no stateful version of such filter.
+ * @throw MissingParameter If required parameters are not provided.
+ * @throw InvalidParameter If parameter value is invalid.
+ */
+template<typename Sample>
+std::unique_ptr<StatefulFilter<Sample>> createStatefulFilter(const std::string& name, const std::vector<FilterParameter>& params)
+{
+    if(name == "ma-filter")
+        return std::make_unique<MovingAverageStream<Sample>>(undecimated(MovingAverage::parse(params)));
+    if(name == "exp-filter")
+        return std::make_unique<ExponentialStream<Sample>>(undecimated(Exponential::parse(params)));
+    if(name == "med-filter")
+        return std::make_unique<MedianStream<Sample>>(undecimated(Median::parse(params)));
+    
+    return nullptr;
+}
+
+template class StatefulFilter<double>;
+template class StatefulFilter<float>;
+template class MovingAverageStream<double>;
+template class MovingAverageStream<float>;
+template class ExponentialStream<double>;
+template class ExponentialStream<float>;
+template class MedianStream<double>;
+template class MedianStream<float>;
+template std::unique_ptr<StatefulFilter<double>> createStatefulFilter<double>(const std::string&, const std::vector<FilterParameter>&);
+template std::unique_ptr<StatefulFilter<float>> createStatefulFilter<float>(const std::string&, const std::vector<FilterParameter>&);
@@ -0,0 +1,153 @@
+/**
+ * @file stream.hpp
+ * @brief This header file contains stateful filters that process a live signal block by block.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. 
+
+#ifndef STREAM_HPP_INCLUDED
+#define STREAM_HPP_INCLUDED
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "utils.hpp"
+#include "filters.hpp"
+#include "slidingmedian.hpp"
+#include "compensatedsum.hpp"
+
+/**
+ * @brief Processing time of the pushed blocks.
+ */
+struct BlockLatency final
+{
+    unsigned long blocks = 0; /** @brief Number of pushed blocks. */
+    size_t samples = 0; /** @brief Number of pushed samples. */
+    long double totalTime = 0; /** @brief Time spent processing all blocks [s]. */
+    long double maxTime = 0; /** @brief Longest block processing time [s]. */
+    long double lastTime = 0; /** @brief Processing time of the last block [s]. */
+};
+
+/**
+ * @brief Filter that keeps its state between blocks of a live signal.
+ * Every output sample is emitted as soon as the input samples it depends on have been pushed,
+ * so the output lags the input by delay() samples. Output of the whole stream is the same as
+ * filtering the whole signal at once.
+ */
+template<typename Sample>
+class StatefulFilter
+{
+public:
+    virtual ~StatefulFilter() = default;
+    
+    size_t push(const Sample* input, size_t count, Sample* output);
+    std::vector<Sample> push(const std::vector<Sample>& input);
+    size_t flush(Sample* output);
+    std::vector<Sample> flush();
+    
+    /** @brief Number of samples by which the output lags the input. */
+    virtual size_t delay() const = 0;
+    
+    /** @brief Forget the signal seen so far, the next sample starts a new signal. */
+    virtual void reset() = 0;
+    
+    const BlockLatency& latency() const;
+    void resetLatency();
+
+protected:
+    /** @brief Filter count samples, write the ready ones to output and return their number. */
+    virtual size_t process(const Sample* input, size_t count, Sample* output) = 0;
+    
+    /** @brief Write out the samples held back at the end of the signal and return their number. */
+    virtual size_t drain(Sample* output) = 0;
+
+private:
+    BlockLatency statistics;
+};
+
+/**
+ * @brief Moving average filter with zero delay. Keeps the last blockSize samples and their sum,
+ * which slides the same way as in the batch filter.
+ */
+template<typename Sample>
+class MovingAverageStream final : public StatefulFilter<Sample>
+{
+public:
+    explicit MovingAverageStream(const MovingAverageParameters& params);
+    size_t delay() const override;
+    void reset() override;
+
+protected:
+    size_t process(const Sample* input, size_t count, Sample* output) override;
+    size_t drain(Sample* output) override;
+
+private:
+    MovingAverageParameters params;
+    std::vector<Sample> history;
+    size_t seen = 0;
+    SlidingSum sum;
+};
+
+/**
+ * @brief Exponential filter with zero delay. Keeps the last output sample.
+ */
+template<typename Sample>
+class ExponentialStream final : public StatefulFilter<Sample>
+{
+public:
+    explicit ExponentialStream(const ExponentialParameters& params);
+    size_t delay() const override;
+    void reset() override;
+
+protected:
+    size_t process(const Sample* input, size_t count, Sample* output) override;
+    size_t drain(Sample* output) override;
+
+private:
+    ExponentialParameters params;
+    Exponential::State state = 0;
+    bool started = false;
+};
+
+/**
+ * @brief Median filter. Window reaches blockSize-1 samples ahead, so that is the delay.
+ * Keeps the window in a SlidingMedian and a ring of its samples.
+ */
+template<typename Sample>
+class MedianStream final : public StatefulFilter<Sample>
+{
+public:
+    explicit MedianStream(const MedianParameters& params);
+    size_t delay() const override;
+    void reset() override;
+
+protected:
+    size_t process(const Sample* input, size_t count, Sample* output) override;
+    size_t drain(Sample* output) override;
+
+private:
+    MedianParameters params;
+    std::vector<Sample> window;
+    size_t seen = 0;
+    SlidingMedian median;
+};
+
+template<typename Sample>
+std::unique_ptr<StatefulFilter<Sample>> createStatefulFilter(const std::string& name, const std::vector<FilterParameter>& params);
+
+#endif
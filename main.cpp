@@ -22,10 +22,425 @@
 
 #include <iostream>
 #include <string>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
 #include "utils.hpp"
 #include "filters.hpp"
+#include "batch.hpp"
+#include "stream.hpp"
+#include "simd.hpp"
 #include "cxxopts/cxxopts.hpp"
 
+/**
+ * @brief Settings of the run collected from the command line.
+ */
+struct RunSettings final
+{
+    std::string inputFile; /** @brief Input file name. */
+    std::string outputFile; /** @brief Output file name. */
+    unsigned int threadCount; /** @brief Number of worker threads. */
+    size_t tileSize; /** @brief Number of samples filtered by a single task. */
+    size_t memoryBudget; /** @brief Buffer size in streaming mode [MiB]. */
+    bool benchmark; /** @brief Compare filter against its reference implementation. */
+    bool mmapInput; /** @brief Filter straight from the mapped input file. */
+    bool mmapOutput; /** @brief Write results straight into the mapped output file. */
+    bool stream; /** @brief Stream the signal through the filter in chunks. */
+    size_t pipeBlockSize; /** @brief Number of samples read from stdin before output is written in pipe mode. */
+    InputScale scale; /** @brief Conversion of integer input samples. */
+    SignalLayout layout; /** @brief Arrangement of the input channels. */
+    std::vector<size_t> shape; /** @brief Shape of the output array. */
+    FilterRunner filter; /** @brief Filter to run. */
+    FilterRunner referenceFilter; /** @brief Reference filter. Empty if there is none. */
+    StreamRunner streamFilter; /** @brief Streaming filter. Set only in streaming mode. */
+    std::string filterName; /** @brief Filter name, used to create its stateful version. */
+    std::vector<FilterParameter> parameters; /** @brief Filter parameters. */
+};
+
+/**
+ * @brief Difference between two output samples. Both NaN or the same infinity match,
+ * any other mismatch in finiteness is an infinite difference, so it is not lost in the maximum.
+ * @param a First sample.
+ * @param b Second sample.
+ * @return Absolute difference.
+ */
+static double sampleDifference(double a, double b)
+{
+    if(std::isfinite(a) && std::isfinite(b))
+        return std::fabs(a - b);
+    if(a == b || (std::isnan(a) && std::isnan(b)))
+        return 0;
+    
+    return std::numeric_limits<double>::infinity();
+}
+
+/**
+ * @brief Push every channel through the stateful version of the filter in blocks of odd sizes
+ * and compare the result with the output of the whole signal filtered at once.
+ * @param stateful Stateful filter.
+ * @param input Input samples.
+ * @param layout Input layout.
+ * @param output Output of the whole signal, one channel after another.
+ * @param scale Conversion of integer input samples.
+ * @return Max difference between the outputs.
+ */
+template<typename Raw, typename Sample>
+static double compareStateful(StatefulFilter<Sample>& stateful, const Raw* input, const SignalLayout& layout, const Sample* output, const InputScale& scale)
+{
+    //block sizes with no common factor, so block edges fall on every position of the window
+    const size_t blockSizes[] = {1, 7, 61, 1021, 4093};
+    const size_t blockSizeCount = sizeof(blockSizes)/sizeof(blockSizes[0]);
+    
+    std::vector<Sample> buffer(layout.length);
+    std::vector<Sample> streamed(layout.length);
+    double maxDifference = 0;
+    for(size_t channel=0; channel<layout.channels; channel++)
+    {
+        const Sample* samples = loadSamples(input + layout.channelOffset(channel), layout.length, layout.stride(), buffer.data(), scale);
+        size_t pushed = 0;
+        size_t emitted = 0;
+        for(size_t block=0; pushed<layout.length; block++)
+        {
+            const size_t count = std::min(blockSizes[block%blockSizeCount], layout.length-pushed);
+            emitted += stateful.push(samples+pushed, count, streamed.data()+emitted);
+            pushed += count;
+        }
+        emitted += stateful.flush(streamed.data()+emitted);
+        if(emitted != layout.length)
+            throw std::runtime_error("Stateful filter lost samples!");
+        
+        const Sample* channelOutput = output + channel*layout.length;
+        for(size_t i=0; i<layout.length; i++)
+            maxDifference = std::max(maxDifference, sampleDifference(channelOutput[i], streamed[i]));
+    }
+    
+    return maxDifference;
+}
+
+/**
+ * @brief Load, filter and save the signal.
+ * Whole pipeline runs on the sample type of the input file, so float32 signals are never widened.
+ * Integer signals are read as they are stored and filtered as Sample.
+ * @param settings Run settings.
+ * @return Exit code.
+ */
+template<typename Raw>
+static int runFilter(const RunSettings& settings)
+{
+    typedef typename FilterSampleType<Raw>::type Sample;
+    const std::string& inputFile = settings.inputFile;
+    const std::string& outputFile = settings.outputFile;
+    const unsigned int threadCount = settings.threadCount;
+    const size_t tileSize = settings.tileSize;
+    const bool benchmark = settings.benchmark;
+    const bool mmapInput = settings.mmapInput;
+    const bool mmapOutput = settings.mmapOutput;
+    const FilterRunner& filter = settings.filter;
+    const FilterRunner& referenceFilter = settings.referenceFilter;
+    
+    //filter the file chunk by chunk without holding it in memory
+    if(settings.stream)
+    {
+        ThreadPool pool(threadCount);
+        std::cout<<"Streaming signal....";
+        StopWatch watch;
+        size_t length = 0;
+        try
+        {
+            NpyReader<Raw> reader(inputFile);
+            if(reader.layout().interleaved)
+                throw std::runtime_error("Only C ordered multi-channel signals can be streamed!");
+            NpyWriter<Sample> writer(outputFile, filter.outputShape(reader.getHeader().shape));
+            
+            //channels are stored one after another and streamed one by one
+            std::vector<Raw> rawBuffer;
+            size_t channelRemaining = 0;
+            const SampleSource<Sample> source = [&](Sample* buffer, size_t count) -> size_t
+            {
+                count = std::min(count, channelRemaining);
+                size_t read;
+                if constexpr(std::is_same<Raw, Sample>::value)
+                    read = reader.read(buffer, count);
+                else
+                {
+                    //convert every block as it is read
+                    rawBuffer.resize(count);
+                    read = reader.read(rawBuffer.data(), count);
+                    convertSamples(rawBuffer.data(), read, buffer, settings.scale);
+                }
+                channelRemaining -= read;
+                return read;
+            };
+            const SampleSink<Sample> sink = [&writer](const Sample* buffer, size_t count){ writer.write(buffer, count); };
+            watch.start();
+            for(size_t channel=0; channel<reader.layout().channels; channel++)
+            {
+                channelRemaining = reader.layout().length;
+                length += settings.streamFilter(source, sink, pool, tileSize, settings.memoryBudget << 20);
+            }
+            writer.close();
+            watch.stop();
+        }
+        catch(std::exception& err)
+        {
+            std::cout<<std::endl<<"ERR: "<<err.what()<<std::endl;
+            return 1;
+        }
+        std::cout<<"Done!"<<std::endl;
+        
+        const PoolStatistics stats = pool.getStatistics();
+        std::cout<<"Signal lenght: "<<length<<" samples"<<std::endl;
+        std::cout<<"Streaming took: "<<watch.getTime()<<"s (including I/O)"<<std::endl;
+        std::cout<<"Average speed: "<<length/watch.getTime()<<" Sa/s"<<std::endl;
+        std::cout<<"Throughput: "<<length*sizeof(Sample)/watch.getTime()/(1 << 20)<<" MiB/s"<<std::endl;
+        std::cout<<"Compute time (all threads): "<<stats.computeTime<<"s"<<std::endl;
+        std::cout<<"Tiles: "<<stats.tasks<<" ("<<stats.stolenTasks<<" stolen)"<<std::endl;
+        return 0;
+    }
+    
+    //load signal
+    std::vector<Raw> signal;
+    std::unique_ptr<MappedSignal<Raw>> mappedSignal;
+    const Raw* input;
+    const SignalLayout& layout = settings.layout;
+    const size_t length = layout.size();
+    const size_t outputLength = layout.channels*filter.outputLength(layout.length);
+    std::cout<<"Loading signal....";
+    try
+    {
+        if(mmapInput)
+        {
+            mappedSignal = std::make_unique<MappedSignal<Raw>>(inputFile);
+            input = mappedSignal->data();
+        }
+        else
+        {
+            signal = loadSignal<Raw>(inputFile);
+            input = signal.data();
+        }
+    }
+    catch(std::exception& err)
+    {
+        std::cout<<std::endl<<"ERR: "<<err.what()<<std::endl;
+        return 1;
+    }
+    std::cout<<"Done!"<<std::endl;
+    std::cout<<"Signal lenght: "<<layout.length<<" samples"<<std::endl;
+    std::cout<<"Channels: "<<layout.channels<<std::endl;
+    if(outputLength != length)
+        std::cout<<"Output length: "<<filter.outputLength(layout.length)<<" samples"<<std::endl;
+    
+    //start workers
+    ThreadPool pool(threadCount);
+    
+    //prepare output
+    std::vector<Sample> outputBuffer;
+    std::unique_ptr<MappedOutputSignal<Sample>> mappedOutput;
+    Sample* output;
+    try
+    {
+        if(mmapOutput)
+        {
+            mappedOutput = std::make_unique<MappedOutputSignal<Sample>>(outputFile, settings.shape);
+            output = mappedOutput->data();
+        }
+        else
+        {
+            outputBuffer.resize(outputLength);
+            output = outputBuffer.data();
+        }
+    }
+    catch(std::exception& err)
+    {
+        std::cout<<"ERR: "<<err.what()<<std::endl;
+        return 1;
+    }
+    
+    //run filer
+    std::cout<<"Running filter....";
+    StopWatch watch;
+    try
+    {
+        watch.start();
+        filter.run(input, layout, output, settings.scale, pool, tileSize);
+        watch.stop();
+        std::cout<<"Done!"<<std::endl;
+        
+        //compare with the reference implementation
+        if(benchmark && referenceFilter)
+        {
+            std::cout<<"Running reference filter....";
+            std::vector<Sample> referenceOutput(outputLength);
+            StopWatch referenceWatch;
+            referenceWatch.start();
+            referenceFilter.run(input, layout, referenceOutput.data(), settings.scale, pool, tileSize);
+            referenceWatch.stop();
+            std::cout<<"Done!"<<std::endl;
+            
+            double maxDifference = 0;
+            for(size_t i=0; i<outputLength; i++)
+                maxDifference = std::max(maxDifference, sampleDifference(output[i], referenceOutput[i]));
+            
+            std::cout<<"Reference filtering took: "<<referenceWatch.getTime()<<"s"<<std::endl;
+            std::cout<<"Speedup: "<<referenceWatch.getTime()/watch.getTime()<<"x"<<std::endl;
+            std::cout<<"Max difference: "<<maxDifference<<std::endl;
+        }
+        else if(benchmark)
+            std::cout<<"No reference implementation to compare with."<<std::endl;
+        
+        //compare with the stateful filter fed block by block, there is none for resampling filters
+        const bool undecimated = filter.rate.up == 1 && filter.rate.down == 1;
+        const std::unique_ptr<StatefulFilter<Sample>> stateful = benchmark && undecimated ? createStatefulFilter<Sample>(settings.filterName, settings.parameters) : nullptr;
+        if(stateful)
+        {
+            std::cout<<"Running stateful filter....";
+            const double maxDifference = compareStateful(*stateful, input, layout, output, settings.scale);
+            std::cout<<"Done!"<<std::endl;
+            std::cout<<"Stateful filter max difference: "<<maxDifference<<std::endl;
+        }
+    }
+    catch(std::exception& err)
+    {
+        std::cout<<std::endl<<"ERR: "<<err.what()<<std::endl;
+        return 1;
+    }
+    
+    //show performance
+    const PoolStatistics stats = pool.getStatistics();
+    std::cout<<"Filtering took: "<<watch.getTime()<<"s"<<std::endl;
+    std::cout<<"Average speed: "<<length/watch.getTime()<<" Sa/s"<<std::endl;
+    std::cout<<"Compute time (all threads): "<<stats.computeTime<<"s"<<std::endl;
+    std::cout<<"Tiles: "<<stats.tasks<<" ("<<stats.stolenTasks<<" stolen)"<<std::endl;
+    std::cout<<"Dispatch overhead: "<<stats.dispatchTime<<"s ("<<100*stats.dispatchTime/stats.wallTime<<"% of wall time)"<<std::endl<<std::endl;
+
+    //save output file
+    std::cout<<"Saving signal....";
+    try
+    {
+        if(mmapOutput)
+            mappedOutput->close();
+        else
+            saveSignal(outputBuffer, settings.shape, outputFile);
+    }
+    catch(std::exception& err)
+    {
+        std::cout<<std::endl<<"ERR: "<<err.what()<<std::endl;
+        return 1;
+    }
+    std::cout<<"Done!"<<std::endl;
+
+    return 0;
+}
+
+/**
+ * @brief Print filter parameters.
+ * @param params Parameters.
+ */
+static void printParameters(const std::vector<FilterParameter>& params)
+{
+    for(const FilterParameter& param : params)
+    {
+        std::cout<<"Parameter "<<param.name<<": ";
+        if(param.text.empty())
+            std::cout<<param.value<<std::endl;
+        else
+            std::cout<<param.text<<std::endl;
+    }
+}
+
+/**
+ * @brief Filter raw samples from stdin and write them to stdout block by block.
+ * Filter state carries across blocks, so output is the same as filtering the whole stream at once.
+ * @param settings Run settings. Input and output file names are not used.
+ * @return Exit code.
+ */
+template<typename Raw>
+static int runPipe(const RunSettings& settings)
+{
+    typedef typename FilterSampleType<Raw>::type Sample;
+    ThreadPool pool(settings.threadCount);
+    StopWatch watch;
+    size_t length = 0;
+    try
+    {
+        std::vector<Raw> rawBuffer;
+        const SampleSource<Sample> source = [&](Sample* buffer, size_t count) -> size_t
+        {
+            size_t read;
+            if constexpr(std::is_same<Raw, Sample>::value)
+                read = std::fread(buffer, sizeof(Sample), count, stdin);
+            else
+            {
+                rawBuffer.resize(count);
+                read = std::fread(rawBuffer.data(), sizeof(Raw), count, stdin);
+                convertSamples(rawBuffer.data(), read, buffer, settings.scale);
+            }
+            if(read < count && std::ferror(stdin))
+                throw std::runtime_error("Can't read from stdin!");
+            return read;
+        };
+        //flush every block so the next program in the pipeline gets it right away
+        const SampleSink<Sample> sink = [](const Sample* buffer, size_t count)
+        {
+            if(std::fwrite(buffer, sizeof(Sample), count, stdout) != count || std::fflush(stdout) != 0)
+                throw std::runtime_error("Can't write to stdout!");
+        };
+        watch.start();
+        length = settings.streamFilter(source, sink, pool, settings.tileSize, settings.memoryBudget << 20, settings.pipeBlockSize);
+        watch.stop();
+    }
+    catch(std::exception& err)
+    {
+        std::cout<<"ERR: "<<err.what()<<std::endl;
+        return 1;
+    }
+    
+    const PoolStatistics stats = pool.getStatistics();
+    std::cout<<"Signal lenght: "<<length<<" samples"<<std::endl;
+    std::cout<<"Streaming took: "<<watch.getTime()<<"s (including I/O)"<<std::endl;
+    std::cout<<"Average speed: "<<length/watch.getTime()<<" Sa/s"<<std::endl;
+    std::cout<<"Compute time (all threads): "<<stats.computeTime<<"s"<<std::endl;
+    std::cout<<"Tiles: "<<stats.tasks<<" ("<<stats.stolenTasks<<" stolen)"<<std::endl;
+    return 0;
+}
+
+/**
+ * @brief Filter every file of the batch and report aggregate throughput.
+ * @param jobs List of jobs.
+ * @param settings Run settings. Input and output file names are not used.
+ * @return Exit code. Non zero if any file failed.
+ */
+static int runBatchMode(const std::vector<BatchJob>& jobs, const RunSettings& settings)
+{
+    ThreadPool pool(settings.threadCount);
+    std::cout<<"Filtering batch....";
+    const BatchStatistics stats = runBatch(jobs, settings.filter, pool, settings.tileSize, settings.scale);
+    std::cout<<"Done!"<<std::endl;
+    
+    for(const BatchFailure& failure : stats.failures)
+        std::cout<<"ERR: "<<failure.job.inputFile<<": "<<failure.message<<std::endl;
+    
+    const PoolStatistics poolStats = pool.getStatistics();
+    const long double ioTime = stats.loadTime + stats.saveTime;
+    const long double exposedTime = std::max(stats.wallTime - stats.filterTime, static_cast<long double>(0));
+    std::cout<<"Files: "<<stats.files<<" filtered, "<<stats.failures.size()<<" failed"<<std::endl;
+    std::cout<<"Samples: "<<stats.samples<<std::endl;
+    std::cout<<"Batch took: "<<stats.wallTime<<"s (including I/O)"<<std::endl;
+    std::cout<<"Filtering took: "<<stats.filterTime<<"s"<<std::endl;
+    std::cout<<"Loading took: "<<stats.loadTime<<"s, saving took: "<<stats.saveTime<<"s"<<std::endl;
+    if(ioTime > 0)
+        std::cout<<"I/O hidden behind filtering: "<<100*std::max(1 - exposedTime/ioTime, static_cast<long double>(0))<<"%"<<std::endl;
+    std::cout<<"Average speed: "<<stats.samples/stats.wallTime<<" Sa/s"<<std::endl;
+    std::cout<<"Throughput: "<<(stats.inputBytes + stats.outputBytes)/stats.wallTime/(1 << 20)<<" MiB/s (read and written)"<<std::endl;
+    std::cout<<"Compute time (all threads): "<<poolStats.computeTime<<"s"<<std::endl;
+    std::cout<<"Tiles: "<<poolStats.tasks<<" ("<<poolStats.stolenTasks<<" stolen)"<<std::endl;
+    return stats.failures.empty() ? 0 : 1;
+}
+
 int main(int argc, char* argv[])
 {
     cxxopts::Options options("Calculon", "Program for applying filters to a signal.");
@@ -35,16 +450,46 @@ int main(int argc, char* argv[])
     ("i,input-file", "Input file name.", cxxopts::value<std::string>())
     ("o,output-file", "Output file name.", cxxopts::value<std::string>())
     ("a,alpha", "Damping coeffiients for exponential filter.", cxxopts::value<double>())
-    ("s,block-size", "Block size for mobing average and median filter.", cxxopts::value<unsigned int>());
+    ("s,block-size", "Block size for mobing average and median filter, window size for Savitzky-Golay filter.", cxxopts::value<unsigned int>())
+    ("tile-size", "Number of samples filtered by a single task.", cxxopts::value<size_t>())
+    ("r,reference", "Use reference implementation of the filter.")
+    ("b,benchmark", "Compare filter against its reference implementation.")
+    ("mmap-input", "Filter straight from the memory mapped input file instead of loading it.")
+    ("mmap-output", "Write results straight into the memory mapped output file.")
+    ("stream", "Stream the signal through the filter in chunks instead of loading it.")
+    ("memory-budget", "Memory used for buffering in streaming mode (MiB).", cxxopts::value<size_t>())
+    ("scale", "Value of one unit of integer input samples.", cxxopts::value<double>())
+    ("offset", "Value of zero integer input sample.", cxxopts::value<double>())
+    ("batch", "Filter every input/output pair listed in the manifest file.", cxxopts::value<std::string>())
+    ("batch-glob", "Filter every file matching the pattern.", cxxopts::value<std::string>())
+    ("output-dir", "Directory for the output files of --batch-glob.", cxxopts::value<std::string>())
+    ("pipe", "Filter raw samples from stdin to stdout.")
+    ("pipe-type", "Type of raw samples on stdin (int16, int32, float32, float64).", cxxopts::value<std::string>())
+    ("pipe-block", "Number of samples read from stdin before output is written.", cxxopts::value<size_t>())
+    ("coefficients", "File with FIR filter coefficients or second order sections (.npy).", cxxopts::value<std::string>())
+    ("fir-method", "FIR convolution method (auto, direct, fft).", cxxopts::value<std::string>())
+    ("up", "Interpolation factor of the resampling filter.", cxxopts::value<unsigned int>())
+    ("down", "Decimation factor of the resampling, moving average, median and exponential filters.", cxxopts::value<unsigned int>())
+    ("poly-order", "Order of the polynomial fitted by the Savitzky-Golay filter.", cxxopts::value<unsigned int>())
+    ("deriv-order", "Order of the derivative computed by the Savitzky-Golay filter (0 smooths).", cxxopts::value<unsigned int>())
+    ("sigma", "Standard deviation of the Gaussian filter in samples.", cxxopts::value<double>())
+    ("simd", "Instruction set of the vectorised kernels (baseline, avx2, avx512). Best supported one by default.", cxxopts::value<std::string>());
 
     //parse argumentss
     auto args = options.parse(argc, argv);
-    if(args.count("input-file") == 0)
+    const bool batch = args.count("batch") || args.count("batch-glob");
+    const bool pipe = args.count("pipe");
+    
+    //stdout carries the samples in pipe mode, all messages go to stderr
+    if(pipe)
+        std::cout.rdbuf(std::cerr.rdbuf());
+    
+    if(args.count("input-file") == 0 && !batch && !pipe)
     {   
         std::cout<<"ERR: Input file not specified!"<<std::endl;
         return 1;
     }
-    if(args.count("output-file") == 0)
+    if(args.count("output-file") == 0 && !batch && !pipe)
     {   
         std::cout<<"ERR: Output file not specified!"<<std::endl;
         return 1;
@@ -60,47 +505,213 @@ int main(int argc, char* argv[])
         return 1;
     }
     //general
-    const std::string inputFile = args["input-file"].as<std::string>();
-    const std::string outputFile = args["output-file"].as<std::string>();
+    const std::string inputFile = args.count("input-file") ? args["input-file"].as<std::string>() : "";
+    const std::string outputFile = args.count("output-file") ? args["output-file"].as<std::string>() : "";
     const std::string filterType = args["filter-type"].as<std::string>();
     const unsigned int threadCount = args["thread-count"].as<unsigned int>();
+    const size_t tileSize = args.count("tile-size") ? args["tile-size"].as<size_t>() : DEFAULT_TILE_SIZE;
+    const bool reference = args.count("reference");
+    const bool benchmark = args.count("benchmark");
+    const bool mmapInput = args.count("mmap-input");
+    const bool mmapOutput = args.count("mmap-output");
+    const bool stream = args.count("stream");
+    const size_t memoryBudget = args.count("memory-budget") ? args["memory-budget"].as<size_t>() : 256;
+    if(tileSize == 0)
+    {
+        std::cout<<"ERR: Tile size must be positive!"<<std::endl;
+        return 1;
+    }
+    if((mmapOutput || stream) && inputFile == outputFile)
+    {
+        std::cout<<"ERR: Output can't overwrite the input file while it is being read!"<<std::endl;
+        return 1;
+    }
+    if(stream && (mmapInput || mmapOutput || benchmark || args.count("reference")))
+    {
+        std::cout<<"ERR: Streaming mode can't be combined with memory mapping, reference or benchmark!"<<std::endl;
+        return 1;
+    }
+    if(batch && (mmapInput || mmapOutput || stream || benchmark))
+    {
+        std::cout<<"ERR: Batch mode can't be combined with memory mapping, streaming or benchmark!"<<std::endl;
+        return 1;
+    }
+    if(pipe && (batch || mmapInput || mmapOutput || stream || benchmark || args.count("reference")))
+    {
+        std::cout<<"ERR: Pipe mode can't be combined with batch, memory mapping, streaming, reference or benchmark!"<<std::endl;
+        return 1;
+    }
+    const std::string pipeType = args.count("pipe-type") ? args["pipe-type"].as<std::string>() : "float64";
+    const size_t pipeBlockSize = args.count("pipe-block") ? args["pipe-block"].as<size_t>() : 4096;
+    if(pipe && pipeType != "int16" && pipeType != "int32" && pipeType != "float32" && pipeType != "float64")
+    {
+        std::cout<<"ERR: Invalid pipe sample type! (int16, int32, float32, float64)"<<std::endl;
+        return 1;
+    }
+    if(pipe && pipeBlockSize == 0)
+    {
+        std::cout<<"ERR: Pipe block size must be positive!"<<std::endl;
+        return 1;
+    }
+    if(args.count("batch-glob") && args.count("output-dir") == 0)
+    {
+        std::cout<<"ERR: Output directory not specified!"<<std::endl;
+        return 1;
+    }
+    
+    //vectorised kernels
+    try
+    {
+        if(args.count("simd"))
+            setSimdLevel(parseSimdLevel(args["simd"].as<std::string>()));
+    }
+    catch(std::exception& err)
+    {
+        std::cout<<"ERR: "<<err.what()<<std::endl;
+        return 1;
+    }
+    
     //filter specific
-    double a;
-    unsigned int blockSize;
+    const FilterInfo* filterInfo = findFilter(filterType);
+    if(!filterInfo)
+    {
+        std::cout<<"ERR: Invalid filter type! (";
+        for(const FilterInfo& info : filterRegistry())
+            std::cout<<(&info == &filterRegistry().front() ? "" : ", ")<<info.name;
+        std::cout<<")"<<std::endl;
+        return 1;
+    }
+    
+    std::vector<FilterParameter> params;
+    if(args.count("block-size"))
+        params.push_back({"block-size", static_cast<double>(args["block-size"].as<unsigned int>())});
+    if(args.count("alpha"))
+        params.push_back({"damping-coeff", args["alpha"].as<double>()});
+    if(args.count("coefficients"))
+        params.push_back({"coefficients", 0, args["coefficients"].as<std::string>()});
+    if(args.count("fir-method"))
+        params.push_back({"fir-method", 0, args["fir-method"].as<std::string>()});
+    if(args.count("up"))
+        params.push_back({"up-factor", static_cast<double>(args["up"].as<unsigned int>())});
+    if(args.count("down"))
+        params.push_back({"down-factor", static_cast<double>(args["down"].as<unsigned int>())});
+    if(args.count("poly-order"))
+        params.push_back({"poly-order", static_cast<double>(args["poly-order"].as<unsigned int>())});
+    if(args.count("deriv-order"))
+        params.push_back({"deriv-order", static_cast<double>(args["deriv-order"].as<unsigned int>())});
+    if(args.count("sigma"))
+        params.push_back({"sigma", args["sigma"].as<double>()});
     
-    if(filterType == "ma-filter")
+    //bind parameters to the filter
+    InputScale scale;
+    if(args.count("scale"))
+        scale.scale = args["scale"].as<double>();
+    if(args.count("offset"))
+        scale.offset = args["offset"].as<double>();
+    
+    RunSettings settings = {inputFile, outputFile, threadCount, tileSize, memoryBudget, benchmark, mmapInput, mmapOutput, stream, pipeBlockSize, scale, {}, {}, {}, {}, {}, filterType, params};
+    try
     {
-        if(args.count("block-size") == 0)
-        {
-            std::cout<<"ERR: Block size not specified!"<<std::endl;
-            return 1;
-        }
-        blockSize = args["block-size"].as<unsigned int>();
+        settings.filter = filterInfo->create(params);
+        if(filterInfo->createReference)
+            settings.referenceFilter = filterInfo->createReference(params);
+        if((stream || pipe) && !filterInfo->createStream)
+            throw std::runtime_error("This filter needs the whole signal and can't be streamed!");
+        if(stream || pipe)
+            settings.streamFilter = filterInfo->createStream(params);
+    }
+    catch(std::exception& err)
+    {
+        std::cout<<"ERR: "<<err.what()<<std::endl;
+        return 1;
     }
     
-    else if(filterType == "exp-filter")
+    if(reference && settings.referenceFilter)
+        settings.filter = settings.referenceFilter;
+    
+    //raw samples from stdin carry no header, their type comes from the command line
+    if(pipe)
     {
-        if(args.count("alpha") == 0)
+        const bool integerInput = pipeType == "int16" || pipeType == "int32";
+        if(!integerInput && (args.count("scale") || args.count("offset")))
         {
-            std::cout<<"ERR: Damping coeffiient not specified!"<<std::endl;
+            std::cout<<"ERR: Scale and offset apply only to integer signals!"<<std::endl;
             return 1;
         }
-        a = args["alpha"].as<double>();
+        
+        std::cout<<"####### Settings summary #######"<<std::endl;
+        std::cout<<"Input: stdin ("<<pipeType<<")"<<std::endl;
+        std::cout<<"Output: stdout ("<<(pipeType == "float64" || pipeType == "int32" ? "float64" : "float32")<<")"<<std::endl;
+        std::cout<<"Thread count: "<<threadCount<<std::endl;
+        std::cout<<"Tile size: "<<tileSize<<" samples"<<std::endl;
+        std::cout<<"Vector instructions: "<<simdLevelName(simdLevel())<<std::endl;
+        std::cout<<"Block size: "<<pipeBlockSize<<" samples"<<std::endl;
+        if(integerInput)
+            std::cout<<"Input scale: "<<scale.scale<<" (offset "<<scale.offset<<")"<<std::endl;
+        std::cout<<"Filter type: "<<filterInfo->description<<std::endl;
+        printParameters(params);
+        std::cout<<std::endl;
+        
+        if(pipeType == "int16")
+            return runPipe<int16_t>(settings);
+        if(pipeType == "int32")
+            return runPipe<int32_t>(settings);
+        return pipeType == "float32" ? runPipe<float>(settings) : runPipe<double>(settings);
     }
     
-    else if(filterType == "med-filter")
+    //files of the batch may hold any supported sample type
+    if(batch)
     {
-        if(args.count("block-size") == 0)
+        std::vector<BatchJob> jobs;
+        try
+        {
+            if(args.count("batch"))
+                jobs = readManifest(args["batch"].as<std::string>());
+            if(args.count("batch-glob"))
+            {
+                const std::vector<BatchJob> matched = globJobs(args["batch-glob"].as<std::string>(), args["output-dir"].as<std::string>());
+                jobs.insert(std::end(jobs), std::begin(matched), std::end(matched));
+            }
+        }
+        catch(std::exception& err)
         {
-            std::cout<<"ERR: Block size not specified!"<<std::endl;
+            std::cout<<"ERR: "<<err.what()<<std::endl;
             return 1;
         }
-        blockSize = args["block-size"].as<unsigned int>();
+        
+        std::cout<<"####### Settings summary #######"<<std::endl;
+        std::cout<<"Batch: "<<jobs.size()<<" files"<<std::endl;
+        std::cout<<"Thread count: "<<threadCount<<std::endl;
+        std::cout<<"Tile size: "<<tileSize<<" samples"<<std::endl;
+        std::cout<<"Vector instructions: "<<simdLevelName(simdLevel())<<std::endl;
+        if(args.count("scale") || args.count("offset"))
+            std::cout<<"Integer input scale: "<<scale.scale<<" (offset "<<scale.offset<<")"<<std::endl;
+        std::cout<<"Filter type: "<<filterInfo->description<<std::endl;
+        printParameters(params);
+        std::cout<<"Implementation: "<<(reference && settings.referenceFilter ? "reference" : "optimized")<<std::endl;
+        std::cout<<std::endl;
+        return runBatchMode(jobs, settings);
     }
     
-    else
+    //pipeline runs on the sample type stored in the input file
+    NpyHeader inputHeader;
+    try
+    {
+        inputHeader = readNpyHeader(inputFile);
+        validateSignalHeader(inputHeader);
+    }
+    catch(std::exception& err)
+    {
+        std::cout<<"ERR: "<<err.what()<<std::endl;
+        return 1;
+    }
+    settings.layout = signalLayout(inputHeader);
+    settings.shape = settings.filter.outputShape(inputHeader.shape);
+    const bool integerInput = inputHeader.type == 'i';
+    const bool singlePrecision = inputHeader.wordSize == (integerInput ? sizeof(int16_t) : sizeof(float));
+    if(!integerInput && (args.count("scale") || args.count("offset")))
     {
-        std::cout<<"ERR: Invalid filter type! (ma-filter, exp-filter, med-filter)"<<std::endl;
+        std::cout<<"ERR: Scale and offset apply only to integer signals!"<<std::endl;
         return 1;
     }
     
@@ -109,53 +720,26 @@ int main(int argc, char* argv[])
     std::cout<<"Input file: "<<inputFile<<std::endl;
     std::cout<<"Output file: "<<outputFile<<std::endl;
     std::cout<<"Thread count: "<<threadCount<<std::endl;
-    if(filterType == "ma-filter")
+    std::cout<<"Tile size: "<<tileSize<<" samples"<<std::endl;
+    std::cout<<"Vector instructions: "<<simdLevelName(simdLevel())<<std::endl;
+    if(integerInput)
     {
-        std::cout<<"Filter type: Moving average filter"<<std::endl;
-        std::cout<<"Block size: "<<blockSize<<std::endl;
-    }
-    if(filterType == "exp-filter")
-    {
-        std::cout<<"Filter type: Exponential averaging filter"<<std::endl;
-        std::cout<<"Damping coeffiient: "<<a<<std::endl;
-    }
-    if(filterType == "med-filter")
-    {
-        std::cout<<"Filter type: Median filter"<<std::endl;
-        std::cout<<"Block size: "<<blockSize<<std::endl;
+        std::cout<<"Input type: int"<<8*inputHeader.wordSize<<std::endl;
+        std::cout<<"Input scale: "<<scale.scale<<" (offset "<<scale.offset<<")"<<std::endl;
     }
+    std::cout<<"Sample type: "<<(singlePrecision ? "float32" : "float64")<<std::endl;
+    if(inputHeader.shape.size() == 2)
+        std::cout<<"Channel order: "<<(settings.layout.interleaved ? "interleaved (Fortran order)" : "contiguous (C order)")<<std::endl;
+    std::cout<<"Input mode: "<<(stream ? "streamed" : mmapInput ? "memory mapped" : "loaded")<<std::endl;
+    std::cout<<"Output mode: "<<(stream ? "streamed" : mmapOutput ? "memory mapped" : "saved")<<std::endl;
+    if(stream)
+        std::cout<<"Memory budget: "<<memoryBudget<<" MiB"<<std::endl;
+    std::cout<<"Filter type: "<<filterInfo->description<<std::endl;
+    printParameters(params);
+    std::cout<<"Implementation: "<<(reference && settings.referenceFilter ? "reference" : "optimized")<<std::endl;
     std::cout<<std::endl;
     
-    //load signal
-    std::cout<<"Loading signal....";
-    std::vector<double> signal = loadSignal(inputFile);
-    std::cout<<"Done!"<<std::endl;
-    std::cout<<"Signal lenght: "<<signal.size()<<" samples"<<std::endl;
-    
-    //run filer
-    std::vector<double> output;
-    std::cout<<"Running filter....";
-    StopWatch watch;
-    watch.start();
-    if(filterType == "ma-filter")
-        output = applyFilter(signal, threadCount, movingAverage_filter, {{"block-size", static_cast<double>(blockSize)}});
-    
-    if(filterType == "exp-filter")
-        output = applyFilter(signal, threadCount, exponential_filter, {{"damping-coeff", a}});
-    
-    if(filterType == "med-filter")
-        output = applyFilter(signal, threadCount, median_filter, {{"block-size", static_cast<double>(blockSize)}});
-    watch.stop();
-    std::cout<<"Done!"<<std::endl;
-    
-    //show performance
-    std::cout<<"Filtering took: "<<watch.getTime()<<"s"<<std::endl;
-    std::cout<<"Average speed: "<<signal.size()/watch.getTime()<<" Sa/s"<<std::endl<<std::endl;
-
-    //save output file
-    std::cout<<"Saving signal....";
-    saveSignal(output, outputFile);
-    std::cout<<"Done!"<<std::endl;
-
-    return 0;
+    if(integerInput)
+        return singlePrecision ? runFilter<int16_t>(settings) : runFilter<int32_t>(settings);
+    return singlePrecision ? runFilter<float>(settings) : runFilter<double>(settings);
 }
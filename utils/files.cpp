@@ -22,25 +22,470 @@
 
 #include "utils.hpp"
 #include "cnpy/cnpy.h"
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <typeinfo>
 
 /**
- * @brief Load signal from file.
+ * @brief Find value of the key in the header dictionary.
+ * @param dictionary Header dictionary.
+ * @param key Key name.
+ * @return Position of the first character of the value.
+ * @throw std::runtime_error If the key is missing.
+ */
+static size_t findHeaderValue(const std::string& dictionary, const std::string& key)
+{
+    size_t position = dictionary.find("'" + key + "'");
+    if(position == std::string::npos)
+        throw std::runtime_error("Invalid npy header: missing '" + key + "' key!");
+    
+    position = dictionary.find(':', position);
+    if(position == std::string::npos)
+        throw std::runtime_error("Invalid npy header: missing value of '" + key + "' key!");
+    
+    return dictionary.find_first_not_of(' ', position+1);
+}
+
+/**
+ * @brief Parse header of a .npy file (format version 1.0, 2.0 or 3.0).
+ * @param buffer Start of the file.
+ * @param bufferSize Number of available bytes.
+ * @return Parsed header.
+ * @throw std::runtime_error If the header is malformed.
+ */
+NpyHeader parseNpyHeader(const char* buffer, size_t bufferSize)
+{
+    if(bufferSize < 10 || std::memcmp(buffer, "\x93NUMPY", 6) != 0)
+        throw std::runtime_error("Not a npy file!");
+    
+    //header length is stored as little endian u16 (1.0) or u32 (2.0 and 3.0)
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(buffer);
+    const unsigned int majorVersion = bytes[6];
+    size_t headerLength;
+    size_t dictionaryOffset;
+    if(majorVersion == 1)
+    {
+        headerLength = bytes[8] | (bytes[9] << 8);
+        dictionaryOffset = 10;
+    }
+    else
+    {
+        if(bufferSize < 12)
+            throw std::runtime_error("Invalid npy header: file too short!");
+        headerLength = bytes[8] | (bytes[9] << 8) | (bytes[10] << 16) | (static_cast<size_t>(bytes[11]) << 24);
+        dictionaryOffset = 12;
+    }
+    
+    if(dictionaryOffset + headerLength > bufferSize)
+        throw std::runtime_error("Invalid npy header: file too short!");
+    
+    const std::string dictionary(buffer+dictionaryOffset, headerLength);
+    NpyHeader header;
+    header.dataOffset = dictionaryOffset + headerLength;
+    
+    //data type, for example '<f8'
+    const size_t descr = findHeaderValue(dictionary, "descr");
+    if(descr+3 >= dictionary.size() || dictionary[descr] != '\'')
+        throw std::runtime_error("Invalid npy header: unsupported descr!");
+    header.byteOrder = dictionary[descr+1];
+    header.type = dictionary[descr+2];
+    header.wordSize = std::strtoul(dictionary.c_str()+descr+3, nullptr, 10);
+    
+    //memory order
+    header.fortranOrder = dictionary.compare(findHeaderValue(dictionary, "fortran_order"), 4, "True") == 0;
+    
+    //shape, for example (100,) or (4, 100)
+    const size_t shapeBegin = findHeaderValue(dictionary, "shape");
+    const size_t shapeEnd = dictionary.find(')', shapeBegin);
+    if(dictionary[shapeBegin] != '(' || shapeEnd == std::string::npos)
+        throw std::runtime_error("Invalid npy header: malformed shape!");
+    
+    const char* position = dictionary.c_str()+shapeBegin+1;
+    const char* end = dictionary.c_str()+shapeEnd;
+    while(position < end)
+    {
+        char* next;
+        const size_t dimension = std::strtoull(position, &next, 10);
+        if(next == position)
+        {
+            position++;
+            continue;
+        }
+        header.shape.push_back(dimension);
+        position = next;
+    }
+    
+    return header;
+}
+
+/**
+ * @brief Read and parse header of a .npy file. File is left positioned at the first element.
+ * @param file Open file positioned at its start.
+ * @return Parsed header.
+ * @throw std::runtime_error If the header can't be read or is malformed.
+ */
+NpyHeader readNpyHeader(std::FILE* file)
+{
+    //magic, version and header length
+    std::vector<char> buffer(12);
+    if(std::fread(buffer.data(), 1, 10, file) != 10)
+        throw std::runtime_error("Not a npy file!");
+    
+    size_t prefixLength = 10;
+    if(static_cast<unsigned char>(buffer[6]) != 1)
+    {
+        if(std::fread(buffer.data()+10, 1, 2, file) != 2)
+            throw std::runtime_error("Not a npy file!");
+        prefixLength = 12;
+    }
+    
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(buffer.data());
+    size_t headerLength = bytes[8] | (bytes[9] << 8);
+    if(prefixLength == 12)
+        headerLength |= (bytes[10] << 16) | (static_cast<size_t>(bytes[11]) << 24);
+    
+    //header dictionary
+    buffer.resize(prefixLength + headerLength);
+    if(std::fread(buffer.data()+prefixLength, 1, headerLength, file) != headerLength)
+        throw std::runtime_error("Invalid npy header: file too short!");
+    
+    return parseNpyHeader(buffer.data(), buffer.size());
+}
+
+/**
+ * @brief Open the file and read its header.
+ * @param fileName Name of the file.
+ * @return Parsed header.
+ * @throw std::runtime_error If the file can't be opened or the header is malformed.
+ */
+NpyHeader readNpyHeader(const std::string& fileName)
+{
+    std::FILE* file = std::fopen(fileName.c_str(), "rb");
+    if(!file)
+        throw std::runtime_error("Can't open " + fileName + "!");
+    
+    try
+    {
+        const NpyHeader header = readNpyHeader(file);
+        std::fclose(file);
+        return header;
+    }
+    catch(...)
+    {
+        std::fclose(file);
+        throw;
+    }
+}
+
+/**
+ * @brief Name of the sample type, for example float32.
+ * @param type Npy type code.
+ * @param wordSize Size of a sample in bytes.
+ * @return Type name.
+ */
+static std::string typeName(char type, size_t wordSize)
+{
+    return (type == 'f' ? "float" : type == 'i' ? "int" : std::string(1, type)) + std::to_string(8*wordSize);
+}
+
+/**
+ * @brief Check that the file holds a signal the filters can process.
+ * @param header Npy header.
+ * @throw std::runtime_error If the array is not a one or two dimensional little endian float32, float64, int16 or int32 array.
+ */
+void validateSignalHeader(const NpyHeader& header)
+{
+    const bool isFloat = header.type == 'f' && (header.wordSize == sizeof(float) || header.wordSize == sizeof(double));
+    const bool isInteger = header.type == 'i' && (header.wordSize == sizeof(int16_t) || header.wordSize == sizeof(int32_t));
+    if(!(isFloat || isInteger) || header.byteOrder == '>')
+        throw std::runtime_error("Only little endian float32, float64, int16 and int32 signals are supported!");
+    if(header.shape.size() != 1 && header.shape.size() != 2)
+        throw std::runtime_error("Only one dimensional signals and [channels, samples] arrays are supported!");
+}
+
+/**
+ * @brief Check that the file holds a signal of the given sample type, so it can be used without conversion.
+ * @param header Npy header.
+ * @param type Expected npy type code.
+ * @param wordSize Expected size of a sample in bytes.
+ * @throw std::runtime_error If the signal is not supported or has different sample type.
+ */
+void validateSignalHeader(const NpyHeader& header, char type, size_t wordSize)
+{
+    validateSignalHeader(header);
+    if(header.type != type || header.wordSize != wordSize)
+        throw std::runtime_error("Signal is stored as " + typeName(header.type, header.wordSize) + ", expected " + typeName(type, wordSize) + "!");
+}
+
+/**
+ * @brief Get arrangement of the channels described by the header.
+ * @param header Header of a valid signal.
+ * @return Signal layout.
+ */
+SignalLayout signalLayout(const NpyHeader& header)
+{
+    SignalLayout layout;
+    if(header.shape.size() == 1)
+        layout.length = header.shape[0];
+    else
+    {
+        layout.channels = header.shape[0];
+        layout.length = header.shape[1];
+        layout.interleaved = header.fortranOrder && layout.channels > 1;
+    }
+    return layout;
+}
+
+/**
+ * @brief Open the file and read its header.
+ * @param fileName Name of the file.
+ * @throw std::runtime_error If the file can't be opened or does not hold a supported signal.
+ */
+template<typename Sample>
+NpyReader<Sample>::NpyReader(const std::string& fileName)
+{
+    file = std::fopen(fileName.c_str(), "rb");
+    if(!file)
+        throw std::runtime_error("Can't open " + fileName + "!");
+    
+    try
+    {
+        header = readNpyHeader(file);
+        validateSignalHeader(header, cnpy::map_type(typeid(Sample)), sizeof(Sample));
+    }
+    catch(...)
+    {
+        std::fclose(file);
+        throw;
+    }
+    remaining = size();
+}
+
+/**
+ * @brief Close the file.
+ */
+template<typename Sample>
+NpyReader<Sample>::~NpyReader()
+{
+    std::fclose(file);
+}
+
+/**
+ * @brief Read next samples.
+ * @param buffer Output buffer.
+ * @param count Maximal number of samples to read.
+ * @return Number of samples read. Less than count only at the end of the signal.
+ * @throw std::runtime_error If the file is shorter than its header says.
+ */
+template<typename Sample>
+size_t NpyReader<Sample>::read(Sample* buffer, size_t count)
+{
+    count = std::min(count, remaining);
+    if(std::fread(buffer, sizeof(Sample), count, file) != count)
+        throw std::runtime_error("Unexpected end of the npy file!");
+    
+    remaining -= count;
+    return count;
+}
+
+/**
+ * @brief Get total number of samples in the file, all channels included.
+ * @return Number of samples.
+ */
+template<typename Sample>
+size_t NpyReader<Sample>::size() const
+{
+    return signalLayout(header).size();
+}
+
+/**
+ * @brief Get arrangement of the channels in the file.
+ * @return Signal layout.
+ */
+template<typename Sample>
+SignalLayout NpyReader<Sample>::layout() const
+{
+    return signalLayout(header);
+}
+
+/**
+ * @brief Get header of the file.
+ * @return Npy header.
+ */
+template<typename Sample>
+const NpyHeader& NpyReader<Sample>::getHeader() const
+{
+    return header;
+}
+
+/**
+ * @brief Create the file and write the header.
+ * @param fileName Name of the file. Existing file is overwritten.
+ * @param shape Shape of the array that will be written.
+ * @throw std::runtime_error If the file can't be created.
+ */
+template<typename Sample>
+NpyWriter<Sample>::NpyWriter(const std::string& fileName, const std::vector<size_t>& shape)
+{
+    file = std::fopen(fileName.c_str(), "wb");
+    if(!file)
+        throw std::runtime_error("Can't create " + fileName + "!");
+    
+    const std::vector<char> header = cnpy::create_npy_header<Sample>(shape);
+    if(std::fwrite(header.data(), 1, header.size(), file) != header.size())
+    {
+        std::fclose(file);
+        throw std::runtime_error("Can't write " + fileName + "!");
+    }
+}
+
+/**
+ * @brief Close the file if close() has not been called. Errors are ignored, use close() to check them.
+ */
+template<typename Sample>
+NpyWriter<Sample>::~NpyWriter()
+{
+    if(file)
+        std::fclose(file);
+}
+
+/**
+ * @brief Write out the buffered samples and close the file.
+ * @throw std::runtime_error If the samples couldn't be written.
+ */
+template<typename Sample>
+void NpyWriter<Sample>::close()
+{
+    if(!file)
+        return;
+    
+    const bool flushed = std::fflush(file) == 0 && !std::ferror(file);
+    const bool closed = std::fclose(file) == 0;
+    file = nullptr;
+    if(!flushed || !closed)
+        throw std::runtime_error("Can't write output file!");
+}
+
+/**
+ * @brief Append samples to the file.
+ * @param data Samples.
+ * @param count Number of samples.
+ * @throw std::runtime_error If the write fails.
+ */
+template<typename Sample>
+void NpyWriter<Sample>::write(const Sample* data, size_t count)
+{
+    if(std::fwrite(data, sizeof(Sample), count, file) != count)
+        throw std::runtime_error("Can't write output file!");
+}
+
+/**
+ * @brief Read samples stored as Stored and convert them to Sample.
+ * @param file File positioned at the first sample.
+ * @param signal Output signal, already sized.
+ * @throw std::runtime_error If the file is shorter than its header says.
+ */
+template<typename Stored, typename Sample>
+static void readConverted(std::FILE* file, std::vector<Sample>& signal)
+{
+    if constexpr(std::is_same<Stored, Sample>::value)
+    {
+        if(std::fread(signal.data(), sizeof(Sample), signal.size(), file) != signal.size())
+            throw std::runtime_error("Unexpected end of the npy file!");
+    }
+    else
+    {
+        //convert in blocks, so the whole file is never held twice
+        std::vector<Stored> buffer(65536);
+        for(size_t i=0; i<signal.size(); i+=buffer.size())
+        {
+            const size_t count = std::min(buffer.size(), signal.size()-i);
+            if(std::fread(buffer.data(), sizeof(Stored), count, file) != count)
+                throw std::runtime_error("Unexpected end of the npy file!");
+            std::copy(buffer.begin(), buffer.begin()+count, signal.begin()+i);
+        }
+    }
+}
+
+/**
+ * @brief Load signal from file. Samples stored in any other supported format are converted without scaling.
+ * Samples of multi-channel signals are returned in the order in which they are stored, see signalLayout().
  * @param fileName Name of the file.
  * @return Vector of data points. 
+ * @throw std::runtime_error If the file can't be read or does not hold a supported signal.
  */
-std::vector<double> loadSignal(const std::string& fileName)
+template<typename Sample>
+std::vector<Sample> loadSignal(const std::string& fileName)
 {
-    cnpy::NpyArray arr = cnpy::npy_load(fileName);
-    double* ptr = arr.data<double>();
-    return std::vector<double>(ptr, ptr+arr.shape[0]);
+    std::FILE* file = std::fopen(fileName.c_str(), "rb");
+    if(!file)
+        throw std::runtime_error("Can't open " + fileName + "!");
+    
+    std::vector<Sample> signal;
+    try
+    {
+        const NpyHeader header = readNpyHeader(file);
+        validateSignalHeader(header);
+        signal.resize(signalLayout(header).size());
+        if(header.type == 'i' && header.wordSize == sizeof(int16_t))
+            readConverted<int16_t>(file, signal);
+        else if(header.type == 'i')
+            readConverted<int32_t>(file, signal);
+        else if(header.wordSize == sizeof(float))
+            readConverted<float>(file, signal);
+        else
+            readConverted<double>(file, signal);
+    }
+    catch(...)
+    {
+        std::fclose(file);
+        throw;
+    }
+    
+    std::fclose(file);
+    return signal;
 }
 
 /**
  * @brief Save signal to a file.
  * @param signal Vector of signal points.
  * @param fileName Name of thw file.
+ * @throw std::runtime_error If the file can't be created or written.
  */
-void saveSignal(const std::vector<double>& signal, const std::string& fileName)
+template<typename Sample>
+void saveSignal(const std::vector<Sample>& signal, const std::string& fileName)
 {
-    cnpy::npy_save(fileName, &signal[0], {signal.size()}, "w");
+    saveSignal(signal, {signal.size()}, fileName);
 }
+
+/**
+ * @brief Save multi-dimensional signal to a file in C order.
+ * @param signal Vector of signal points.
+ * @param shape Array shape.
+ * @param fileName Name of thw file.
+ * @throw std::runtime_error If the file can't be created or written.
+ */
+template<typename Sample>
+void saveSignal(const std::vector<Sample>& signal, const std::vector<size_t>& shape, const std::string& fileName)
+{
+    NpyWriter<Sample> writer(fileName, shape);
+    writer.write(signal.data(), signal.size());
+    writer.close();
+}
+
+template class NpyReader<double>;
+template class NpyReader<float>;
+template class NpyReader<int16_t>;
+template class NpyReader<int32_t>;
+template class NpyWriter<double>;
+template class NpyWriter<float>;
+template std::vector<double> loadSignal<double>(const std::string& fileName);
+template std::vector<float> loadSignal<float>(const std::string& fileName);
+template std::vector<int16_t> loadSignal<int16_t>(const std::string& fileName);
+template std::vector<int32_t> loadSignal<int32_t>(const std::string& fileName);
+template void saveSignal<double>(const std::vector<double>& signal, const std::string& fileName);
+template void saveSignal<float>(const std::vector<float>& signal, const std::string& fileName);
+template void saveSignal<double>(const std::vector<double>& signal, const std::vector<size_t>& shape, const std::string& fileName);
+template void saveSignal<float>(const std::vector<float>& signal, const std::vector<size_t>& shape, const std::string& fileName);
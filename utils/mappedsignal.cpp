@@ -0,0 +1,224 @@
+/**
+ * @file mappedsignal.cpp
+ * @brief This source file contains code for memory mapped signal files.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "utils.hpp"
+#include "cnpy/cnpy.h"
+#include <stdexcept>
+#include <typeinfo>
+#include <numeric>
+#include <functional>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * @brief Map the file and validate its header.
+ * @param fileName Name of the file.
+ * @throw std::runtime_error If the file can't be mapped or is not a one or two dimensional array of Sample values.
+ */
+template<typename Sample>
+MappedSignal<Sample>::MappedSignal(const std::string& fileName)
+{
+    const int file = open(fileName.c_str(), O_RDONLY);
+    if(file < 0)
+        throw std::runtime_error("Can't open " + fileName + ": " + std::strerror(errno));
+    
+    struct stat status;
+    if(fstat(file, &status) != 0)
+    {
+        close(file);
+        throw std::runtime_error("Can't stat " + fileName + ": " + std::strerror(errno));
+    }
+    
+    mappingSize = status.st_size;
+    mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, file, 0);
+    close(file); //mapping keeps its own reference to the file
+    if(mapping == MAP_FAILED)
+    {
+        mapping = nullptr;
+        throw std::runtime_error("Can't map " + fileName + ": " + std::strerror(errno));
+    }
+    
+    try
+    {
+        header = parseNpyHeader(static_cast<const char*>(mapping), mappingSize);
+        validateSignalHeader(header, cnpy::map_type(typeid(Sample)), sizeof(Sample));
+        if(header.dataOffset%sizeof(Sample) != 0 || header.dataOffset + size()*sizeof(Sample) > mappingSize)
+            throw std::runtime_error("Invalid npy file: misaligned or truncated data!");
+    }
+    catch(...)
+    {
+        munmap(mapping, mappingSize);
+        throw;
+    }
+    
+    //filters stream through the signal front to back, ask for aggressive read ahead
+    madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+}
+
+/**
+ * @brief Unmap the file.
+ */
+template<typename Sample>
+MappedSignal<Sample>::~MappedSignal()
+{
+    if(mapping)
+        munmap(mapping, mappingSize);
+}
+
+/**
+ * @brief Get pointer to the first sample.
+ * @return Pointer to the samples.
+ */
+template<typename Sample>
+const Sample* MappedSignal<Sample>::data() const
+{
+    return reinterpret_cast<const Sample*>(static_cast<const char*>(mapping) + header.dataOffset);
+}
+
+/**
+ * @brief Get total number of samples, all channels included.
+ * @return Number of samples.
+ */
+template<typename Sample>
+size_t MappedSignal<Sample>::size() const
+{
+    return signalLayout(header).size();
+}
+
+/**
+ * @brief Get arrangement of the channels in the file.
+ * @return Signal layout.
+ */
+template<typename Sample>
+SignalLayout MappedSignal<Sample>::layout() const
+{
+    return signalLayout(header);
+}
+
+/**
+ * @brief Get header of the file.
+ * @return Npy header.
+ */
+template<typename Sample>
+const NpyHeader& MappedSignal<Sample>::getHeader() const
+{
+    return header;
+}
+
+/**
+ * @brief Create the output file with its final size, write the header and map the payload.
+ * @param fileName Name of the file. Existing file is overwritten.
+ * @param shape Array shape.
+ * @throw std::runtime_error If the file can't be created or mapped.
+ */
+template<typename Sample>
+MappedOutputSignal<Sample>::MappedOutputSignal(const std::string& fileName, const std::vector<size_t>& shape):
+length(std::accumulate(shape.begin(), shape.end(), static_cast<size_t>(1), std::multiplies<size_t>()))
+{
+    const std::vector<char> header = cnpy::create_npy_header<Sample>(shape);
+    dataOffset = header.size();
+    mappingSize = dataOffset + length*sizeof(Sample);
+    
+    const int file = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(file < 0)
+        throw std::runtime_error("Can't create " + fileName + ": " + std::strerror(errno));
+    
+    //reserve real blocks, a sparse file would fail with SIGBUS in a worker once the disk is full
+    const int error = posix_fallocate(file, 0, mappingSize);
+    if(error != 0)
+    {
+        ::close(file);
+        throw std::runtime_error("Can't allocate " + fileName + ": " + std::strerror(error));
+    }
+    
+    mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    ::close(file);
+    if(mapping == MAP_FAILED)
+    {
+        mapping = nullptr;
+        throw std::runtime_error("Can't map " + fileName + ": " + std::strerror(errno));
+    }
+    
+    std::memcpy(mapping, header.data(), header.size());
+    madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+}
+
+/**
+ * @brief Unmap the file without waiting for the write back, use close() to check the result.
+ */
+template<typename Sample>
+MappedOutputSignal<Sample>::~MappedOutputSignal()
+{
+    if(mapping)
+        munmap(mapping, mappingSize);
+}
+
+/**
+ * @brief Write all samples back to the file and unmap it.
+ * @throw std::runtime_error If the samples couldn't be written.
+ */
+template<typename Sample>
+void MappedOutputSignal<Sample>::close()
+{
+    if(!mapping)
+        return;
+    
+    const bool synced = msync(mapping, mappingSize, MS_SYNC) == 0;
+    const int error = errno;
+    const bool unmapped = munmap(mapping, mappingSize) == 0;
+    mapping = nullptr;
+    if(!synced)
+        throw std::runtime_error(std::string("Can't write output file: ") + std::strerror(error));
+    if(!unmapped)
+        throw std::runtime_error(std::string("Can't unmap output file: ") + std::strerror(errno));
+}
+
+/**
+ * @brief Get pointer to the first sample.
+ * @return Pointer to the samples.
+ */
+template<typename Sample>
+Sample* MappedOutputSignal<Sample>::data()
+{
+    return reinterpret_cast<Sample*>(static_cast<char*>(mapping) + dataOffset);
+}
+
+/**
+ * @brief Get total number of samples.
+ * @return Number of samples.
+ */
+template<typename Sample>
+size_t MappedOutputSignal<Sample>::size() const
+{
+    return length;
+}
+
+template class MappedSignal<double>;
+template class MappedSignal<float>;
+template class MappedSignal<int16_t>;
+template class MappedSignal<int32_t>;
+template class MappedOutputSignal<double>;
+template class MappedOutputSignal<float>;
@@ -0,0 +1,281 @@
+/**
+ * @file threadpool.cpp
+ * @brief This source file contains code for the thread pool.
+ * @author Krzysztof Adamkiewicz
+ * @date 18/10/2026
+ */
+
+// This file is part of measurements laboratory excercise solution.
+// Copyright (c) 2019 Krzysztof Adamkiewicz <kadamkiewicz835@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the “Software”), to deal in the
+// Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so, subject to the
+// following conditions: THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "utils.hpp"
+#include <algorithm>
+#include <memory>
+#include <map>
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Convert time interval to seconds.
+ * @param interval Time interval.
+ * @return Interval length in seconds.
+ */
+static inline long double toSeconds(Clock::duration interval)
+{
+    return std::chrono::duration_cast<std::chrono::duration<long double>>(interval).count();
+}
+
+/**
+ * @brief Create pool and start the worker threads.
+ * @param threadCount Number of worker threads. At least one thread is always created.
+ */
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+    if(threadCount < 1)
+        threadCount = 1;
+
+    busyTime.resize(threadCount);
+    for(unsigned int i=0; i<threadCount; i++)
+        queues.push_back(std::make_unique<WorkQueue>());
+    workers.reserve(threadCount);
+    for(unsigned int i=0; i<threadCount; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+/**
+ * @brief Stop and join all worker threads.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    std::for_each(std::begin(workers), std::end(workers), [](std::thread& thread){ thread.join(); });
+}
+
+/**
+ * @brief Get number of worker threads.
+ * @return Number of worker threads.
+ */
+unsigned int ThreadPool::size() const
+{
+    return workers.size();
+}
+
+/**
+ * @brief Execute task for every index in < 0, taskCount ) and wait until all of them are done.
+ * Every worker starts with a contiguous range of indices, idle workers steal from the back of the others.
+ * Concurrent callers are served one after another. Must not be called from inside a task of the same
+ * pool, the nested call would wait for the run that is waiting for it.
+ * @param taskCount Number of tasks.
+ * @param task Task function. Receives index of the task.
+ * @throw Rethrows first exception thrown by any of the tasks.
+ */
+void ThreadPool::run(size_t taskCount, const std::function<void(size_t)>& task)
+{
+    if(taskCount == 0)
+        return;
+
+    std::lock_guard<std::mutex> runLock(runMutex);
+    const Clock::time_point start = Clock::now();
+
+    //deal tasks to the workers
+    const size_t workerCount = workers.size();
+    for(size_t i=0; i<workerCount; i++)
+    {
+        std::lock_guard<std::mutex> lock(queues[i]->mutex);
+        for(size_t j=i*taskCount/workerCount; j<(i+1)*taskCount/workerCount; j++)
+            queues[i]->tasks.push_back(j);
+    }
+
+    //publish the job
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &task;
+        error = nullptr;
+        executedTasks = 0;
+        stolenTasks = 0;
+        activeWorkers = workers.size();
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    //wait for workers to finish
+    std::exception_ptr failure;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this](){ return activeWorkers == 0; });
+        job = nullptr;
+        failure = error;
+
+        const long double wall = toSeconds(Clock::now() - start);
+        const long double longest = *std::max_element(std::begin(busyTime), std::end(busyTime));
+        statistics.runs++;
+        statistics.tasks += executedTasks;
+        statistics.stolenTasks += stolenTasks;
+        statistics.wallTime += wall;
+        for(long double busy : busyTime)
+            statistics.computeTime += busy;
+        statistics.dispatchTime += std::max(wall - longest, static_cast<long double>(0));
+    }
+
+    if(failure)
+        std::rethrow_exception(failure);
+}
+
+/**
+ * @brief Get statistics accumulated since creation or last reset.
+ * @return Pool statistics.
+ */
+PoolStatistics ThreadPool::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+/**
+ * @brief Reset accumulated statistics.
+ */
+void ThreadPool::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    statistics = PoolStatistics();
+}
+
+/**
+ * @brief Main loop of the worker thread.
+ * @param workerId Index of the worker.
+ */
+void ThreadPool::workerLoop(unsigned int workerId)
+{
+    unsigned long seenGeneration = 0;
+    while(true)
+    {
+        const std::function<void(size_t)>* current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this, seenGeneration](){ return stopping || generation != seenGeneration; });
+            if(stopping)
+                return;
+
+            seenGeneration = generation;
+            current = job;
+        }
+
+        //run own tasks first, then steal until there is nothing left
+        long double busy = 0;
+        unsigned long executed = 0;
+        unsigned long stolen = 0;
+        size_t i;
+        while(true)
+        {
+            if(!popTask(workerId, i))
+            {
+                if(!stealTask(workerId, i))
+                    break;
+                stolen++;
+            }
+            
+            const Clock::time_point taskStart = Clock::now();
+            try
+            {
+                (*current)(i);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(!error)
+                    error = std::current_exception();
+            }
+            busy += toSeconds(Clock::now() - taskStart);
+            executed++;
+        }
+
+        //report back
+        std::lock_guard<std::mutex> lock(mutex);
+        busyTime[workerId] = busy;
+        executedTasks += executed;
+        stolenTasks += stolen;
+        if(--activeWorkers == 0)
+            finished.notify_one();
+    }
+}
+
+/**
+ * @brief Take task from the front of worker's own deque.
+ * @param workerId Index of the worker.
+ * @param task Output for the task index.
+ * @return False if the deque is empty.
+ */
+bool ThreadPool::popTask(unsigned int workerId, size_t& task)
+{
+    WorkQueue& queue = *queues[workerId];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty())
+        return false;
+
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+/**
+ * @brief Take task from the back of another worker's deque.
+ * Tasks are never added during the run, so failing on every deque means the run is finished.
+ * @param workerId Index of the thief.
+ * @param task Output for the task index.
+ * @return False if all deques are empty.
+ */
+bool ThreadPool::stealTask(unsigned int workerId, size_t& task)
+{
+    const size_t workerCount = queues.size();
+    for(size_t i=1; i<workerCount; i++)
+    {
+        WorkQueue& queue = *queues[(workerId+i)%workerCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.tasks.empty())
+            continue;
+
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Get process wide thread pool with the given number of threads.
+ * Every thread count gets its own pool, created on first use and kept until the process ends,
+ * so a reference returned earlier stays valid while other callers ask for other counts.
+ * @param threadCount Number of worker threads.
+ * @return Reference to the pool.
+ */
+ThreadPool& defaultThreadPool(unsigned int threadCount)
+{
+    static std::mutex poolMutex;
+    static std::map<unsigned int, std::unique_ptr<ThreadPool>> pools;
+
+    if(threadCount < 1)
+        threadCount = 1;
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    std::unique_ptr<ThreadPool>& pool = pools[threadCount];
+    if(!pool)
+        pool = std::make_unique<ThreadPool>(threadCount);
+
+    return *pool;
+}
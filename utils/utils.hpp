@@ -26,6 +26,15 @@
 #include <chrono>
 #include <vector>
 #include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <deque>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
 
 /**
  * @brief Stopwatch class.
@@ -45,8 +54,218 @@ private:
     bool running = false;
 };
 
-std::vector<double> loadSignal(const std::string& fileName);
-void saveSignal(const std::vector<double>& signal, const std::string& fileName);
+/**
+ * @brief Statistics collected by the thread pool.
+ */
+struct PoolStatistics final
+{
+    unsigned long runs = 0; /** @brief Number of parallel runs. */
+    unsigned long tasks = 0; /** @brief Number of executed tasks. */
+    unsigned long stolenTasks = 0; /** @brief Number of tasks executed by a worker other than their owner. */
+    long double wallTime = 0; /** @brief Time spent inside run() [s]. */
+    long double computeTime = 0; /** @brief Time spent executing tasks, summed over all workers [s]. */
+    long double dispatchTime = 0; /** @brief Part of the wall time not covered by the busiest worker [s]. */
+};
+
+/**
+ * @brief Pool of long lived worker threads.
+ * Threads are created once and reused by every call to run().
+ * Every worker owns a deque of tasks and steals from the others when its own deque runs dry.
+ * run() must not be called from inside one of its own tasks, it would deadlock.
+ */
+class ThreadPool final
+{
+public:
+    explicit ThreadPool(unsigned int threadCount);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int size() const;
+    void run(size_t taskCount, const std::function<void(size_t)>& task);
+    PoolStatistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    /** @brief Task deque owned by a single worker. */
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void workerLoop(unsigned int workerId);
+    bool popTask(unsigned int workerId, size_t& task);
+    bool stealTask(unsigned int workerId, size_t& task);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<long double> busyTime; //time spent on tasks by each worker during current run
+    mutable std::mutex mutex;
+    std::mutex runMutex; //serializes concurrent callers of run()
+    std::condition_variable wakeUp;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* job = nullptr;
+    std::exception_ptr error;
+    unsigned long generation = 0;
+    unsigned int activeWorkers = 0;
+    unsigned long executedTasks = 0;
+    unsigned long stolenTasks = 0;
+    bool stopping = false;
+    PoolStatistics statistics;
+};
+
+ThreadPool& defaultThreadPool(unsigned int threadCount);
+
+/**
+ * @brief Header of a .npy file.
+ */
+struct NpyHeader final
+{
+    char byteOrder; /** @brief Byte order: '<' little endian, '>' big endian, '|' not applicable. */
+    char type; /** @brief Type code: 'f' float, 'i' signed integer, 'u' unsigned integer... */
+    size_t wordSize; /** @brief Size of a single element in bytes. */
+    std::vector<size_t> shape; /** @brief Array dimensions. */
+    bool fortranOrder; /** @brief True if the array is stored in column major order. */
+    size_t dataOffset; /** @brief Offset of the first element from the start of the file. */
+};
+
+/**
+ * @brief Arrangement of the channels of a signal in memory.
+ * Signal is a [channels, samples] array, one dimensional signals have a single channel.
+ */
+struct SignalLayout final
+{
+    size_t channels = 1; /** @brief Number of channels. */
+    size_t length = 0; /** @brief Number of samples in every channel. */
+    bool interleaved = false; /** @brief Samples of one time instant are stored together (Fortran order) instead of whole channels (C order). */
+    
+    /** @brief Distance between neighbouring samples of a channel. */
+    size_t stride() const
+    {
+        return interleaved ? channels : 1;
+    }
+    
+    /** @brief Offset of the first sample of the channel. */
+    size_t channelOffset(size_t channel) const
+    {
+        return interleaved ? channel : channel*length;
+    }
+    
+    /** @brief Total number of samples. */
+    size_t size() const
+    {
+        return channels*length;
+    }
+};
+
+/** @brief Number of samples in a single 512 bit vector register. */
+template<typename Sample>
+constexpr size_t VECTOR_LANES = 64/sizeof(Sample);
+
+/**
+ * @brief Read-only memory mapping of a .npy signal, a [channels, samples] array in C or Fortran order.
+ * Samples are read straight from the page cache, nothing is copied,
+ * so the file must already hold Sample values. See layout() for the arrangement of the channels.
+ */
+template<typename Sample>
+class MappedSignal final
+{
+public:
+    explicit MappedSignal(const std::string& fileName);
+    ~MappedSignal();
+    MappedSignal(const MappedSignal&) = delete;
+    MappedSignal& operator=(const MappedSignal&) = delete;
+
+    const Sample* data() const;
+    size_t size() const;
+    SignalLayout layout() const;
+    const NpyHeader& getHeader() const;
+
+private:
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    NpyHeader header;
+};
+
+/**
+ * @brief Writable memory mapping of a floating point .npy output file, always in C order.
+ * File is created with its final size and the header already in place,
+ * so workers can write results straight into the page cache.
+ * Call close() to find out whether the samples reached the file.
+ */
+template<typename Sample>
+class MappedOutputSignal final
+{
+public:
+    MappedOutputSignal(const std::string& fileName, const std::vector<size_t>& shape);
+    ~MappedOutputSignal();
+    MappedOutputSignal(const MappedOutputSignal&) = delete;
+    MappedOutputSignal& operator=(const MappedOutputSignal&) = delete;
+
+    void close();
+    Sample* data();
+    size_t size() const;
+
+private:
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    size_t dataOffset = 0;
+    size_t length = 0;
+};
+
+/**
+ * @brief Sequential reader of a .npy signal, a [channels, samples] array in C or Fortran order.
+ * Samples are read in the order in which they are stored. Used to stream signals that do not fit into memory.
+ */
+template<typename Sample>
+class NpyReader final
+{
+public:
+    explicit NpyReader(const std::string& fileName);
+    ~NpyReader();
+    NpyReader(const NpyReader&) = delete;
+    NpyReader& operator=(const NpyReader&) = delete;
+
+    size_t read(Sample* buffer, size_t count);
+    size_t size() const;
+    SignalLayout layout() const;
+    const NpyHeader& getHeader() const;
+
+private:
+    std::FILE* file = nullptr;
+    NpyHeader header;
+    size_t remaining = 0;
+};
+
+/**
+ * @brief Sequential writer of a floating point .npy file of known shape, in C order.
+ */
+template<typename Sample>
+class NpyWriter final
+{
+public:
+    NpyWriter(const std::string& fileName, const std::vector<size_t>& shape);
+    ~NpyWriter();
+    NpyWriter(const NpyWriter&) = delete;
+    NpyWriter& operator=(const NpyWriter&) = delete;
+
+    void write(const Sample* data, size_t count);
+    void close();
+
+private:
+    std::FILE* file = nullptr;
+};
+
+NpyHeader parseNpyHeader(const char* buffer, size_t bufferSize);
+NpyHeader readNpyHeader(std::FILE* file);
+NpyHeader readNpyHeader(const std::string& fileName);
+void validateSignalHeader(const NpyHeader& header);
+void validateSignalHeader(const NpyHeader& header, char type, size_t wordSize);
+SignalLayout signalLayout(const NpyHeader& header);
+template<typename Sample> std::vector<Sample> loadSignal(const std::string& fileName);
+template<typename Sample> void saveSignal(const std::vector<Sample>& signal, const std::string& fileName);
+template<typename Sample> void saveSignal(const std::vector<Sample>& signal, const std::vector<size_t>& shape, const std::string& fileName);
 
 
 #endif